@@ -0,0 +1,197 @@
+#include "anchor.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+LetterPositions* LetterPositions_create(const Grid* grid, RowRange range) {
+    LetterPositions* positions = (LetterPositions*)calloc(1, sizeof(LetterPositions));
+    if (!positions) return NULL;
+
+    int halo = grid->halo;
+    positions->firstRow = range.start - halo;
+    positions->bandRows = (range.end - range.start) + 2 * halo;
+
+    // Letter histogram of the band, which also numbers the letters
+    long histogram[256] = {0};
+    for (int r = 0; r < positions->bandRows; r++) {
+        const char* cells = Grid_cellPtr(grid, positions->firstRow + r, -halo);
+        for (int x = 0; x < grid->stride; x++) {
+            histogram[(unsigned char)cells[x]]++;
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        if (histogram[c] > 0) positions->symbols[c] = (unsigned char)(++positions->symbolCount);
+    }
+
+    int symbols = positions->symbolCount > 0 ? positions->symbolCount : 1;
+    size_t slots = (size_t)symbols * positions->bandRows + 1;
+    positions->rowStarts = (int*)calloc(slots, sizeof(int));
+    positions->counts = (long*)calloc(symbols, sizeof(long));
+    positions->rangeCounts = (long*)calloc(symbols, sizeof(long));
+    positions->columns = (int*)malloc(((size_t)positions->bandRows * grid->stride + 1) * sizeof(int));
+    int* fill = (int*)malloc(slots * sizeof(int));
+    if (!positions->rowStarts || !positions->counts || !positions->rangeCounts ||
+        !positions->columns || !fill) {
+        free(fill);
+        LetterPositions_destroy(positions);
+        return NULL;
+    }
+
+    // Counting sort of the band cells by (letter, row); columns stay ascending
+    for (int r = 0; r < positions->bandRows; r++) {
+        int row = positions->firstRow + r;
+        const char* cells = Grid_cellPtr(grid, row, -halo);
+        for (int x = 0; x < grid->stride; x++) {
+            int symbol = positions->symbols[(unsigned char)cells[x]] - 1;
+            positions->rowStarts[(size_t)symbol * positions->bandRows + r + 1]++;
+            positions->counts[symbol]++;
+            if (row >= range.start && row < range.end && x >= halo && x < halo + grid->cols) {
+                positions->rangeCounts[symbol]++;
+            }
+        }
+    }
+    for (size_t s = 0; s + 1 < slots; s++) {
+        positions->rowStarts[s + 1] += positions->rowStarts[s];
+        fill[s] = positions->rowStarts[s];
+    }
+    for (int r = 0; r < positions->bandRows; r++) {
+        const char* cells = Grid_cellPtr(grid, positions->firstRow + r, -halo);
+        for (int x = 0; x < grid->stride; x++) {
+            int symbol = positions->symbols[(unsigned char)cells[x]] - 1;
+            positions->columns[fill[(size_t)symbol * positions->bandRows + r]++] = x - halo;
+        }
+    }
+    free(fill);
+
+    debugPrint("DEBUG Anchor: %d letters over %d band rows\n",
+               positions->symbolCount, positions->bandRows);
+    return positions;
+}
+
+void LetterPositions_destroy(LetterPositions* positions) {
+    if (!positions) return;
+
+    free(positions->columns);
+    free(positions->rowStarts);
+    free(positions->counts);
+    free(positions->rangeCounts);
+    free(positions);
+}
+
+// Index of the word's rarest letter in the band, the earliest on ties, or
+// -1 when some letter does not occur there at all
+static int chooseAnchor(const LetterPositions* positions, const char* folded, int len) {
+    int anchor = -1;
+    long fewest = 0;
+    for (int k = 0; k < len; k++) {
+        int symbol = positions->symbols[(unsigned char)folded[k]];
+        if (!symbol) return -1;
+        if (anchor < 0 || positions->counts[symbol - 1] < fewest) {
+            anchor = k;
+            fewest = positions->counts[symbol - 1];
+        }
+    }
+    return anchor;
+}
+
+// Tries every cell holding the anchor letter whose word would start in
+// range, checking the letters after the anchor, then those before it
+static bool searchFromAnchor(const Grid* grid, const LetterPositions* positions, int w,
+                             const char* folded, int len, int anchor, Direction dir,
+                             RowRange range, long* candidates,
+                             SearchHit** hits, int* numHits, int* capacity) {
+    DirectionVector vector = DIRECTION_VECTORS[dir];
+    int step = Grid_stepOffset(grid, vector.dx, vector.dy);
+    int symbol = positions->symbols[(unsigned char)folded[anchor]] - 1;
+    const int* rowStarts = positions->rowStarts + (size_t)symbol * positions->bandRows;
+
+    for (int row = range.start; row < range.end; row++) {
+        int anchorRow = row + anchor * vector.dx;
+        int bandRow = anchorRow - positions->firstRow;
+
+        for (int p = rowStarts[bandRow]; p < rowStarts[bandRow + 1]; p++) {
+            int col = positions->columns[p] - anchor * vector.dy;
+            if (col < 0 || col >= grid->cols) continue;
+            (*candidates)++;
+
+            const char* cell = Grid_cellPtr(grid, anchorRow, positions->columns[p]);
+            if (matchesFoldedWord(cell + step, step, folded + anchor + 1, len - anchor - 1) &&
+                matchesFoldedWord(cell - (ptrdiff_t)anchor * step, step, folded, anchor) &&
+                !pushSearchHit(hits, numHits, capacity, (SearchHit){w, row, col, dir})) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Start positions that anchoring every word on its first letter would try
+// in the range positions was built for
+long countFirstLetterCandidates(const LetterPositions* positions, const WordList* words) {
+    long candidates = 0;
+    for (int w = 0; w < words->count; w++) {
+        int first = positions->symbols[(unsigned char)WordList_folded(words, w)[0]];
+        if (first && WordList_length(words, w) > 0) {
+            candidates += positions->rangeCounts[first - 1] * DIRECTIONS_COUNT;
+        }
+    }
+    return candidates;
+}
+
+// Tries the anchors of every word starting in range against positions built
+// beforehand over range or a band containing it, so the row blocks of one
+// search can share them. Counts the start positions tried in results.
+void searchAnchorRows(Grid* grid, const LetterPositions* positions, const WordList* words,
+                      RowRange range, ProcessResults* results) {
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    bool ok = hits != NULL;
+
+    for (int w = 0; w < words->count && ok; w++) {
+        const char* folded = WordList_folded(words, w);
+        int len = WordList_length(words, w);
+        if (len == 0) continue;
+
+        int anchor = chooseAnchor(positions, folded, len);
+        if (anchor < 0) continue;
+
+        for (Direction dir = 0; dir < DIRECTIONS_COUNT && ok; dir++) {
+            ok = searchFromAnchor(grid, positions, w, folded, len, anchor, dir, range,
+                                  &results->candidates, &hits, &numHits, &hitCapacity);
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for anchored matches\n");
+        free(hits);
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    appendSortedHits(grid, words, hits, numHits, results);
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+    debugPrint("Anchored search found %d matches in rows %d to %d\n",
+               numHits, range.start, range.end - 1);
+    free(hits);
+}
+
+// Anchors each word on its rarest letter instead of its first, so only
+// the cells holding that letter are tried. Counts the start positions
+// tried, and those the first letter would have given, in results.
+void searchWordsAnchored(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results) {
+    LetterPositions* positions = Grid_ensureSearchLayout(grid, words->longest - 1)
+                                 ? LetterPositions_create(grid, range) : NULL;
+    if (searchWordsFallback(grid, words, range, results, positions != NULL)) return;
+
+    results->firstLetterCandidates += countFirstLetterCandidates(positions, words);
+    searchAnchorRows(grid, positions, words, range, results);
+    LetterPositions_destroy(positions);
+}
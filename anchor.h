@@ -0,0 +1,30 @@
+#ifndef ANCHOR_H
+#define ANCHOR_H
+
+#include "types.h"
+#include "grid.h"
+
+// Where each letter occurs in a band of the padded layout: rows
+// [range.start - halo, range.end + halo) and columns [-halo, cols + halo),
+// so every cell of a word starting in range is inside it. Columns are
+// grouped by letter, then by row.
+typedef struct {
+    int* columns;
+    int* rowStarts;         // symbolCount x bandRows + 1 offsets into columns
+    long* counts;           // Cells of each letter in the band
+    long* rangeCounts;      // Cells of each letter in the range itself
+    int symbolCount;
+    int firstRow;           // Grid row of band row 0
+    int bandRows;
+    unsigned char symbols[256];     // Byte -> symbol + 1, 0 when absent
+} LetterPositions;
+
+LetterPositions* LetterPositions_create(const Grid* grid, RowRange range);
+void LetterPositions_destroy(LetterPositions* positions);
+long countFirstLetterCandidates(const LetterPositions* positions, const WordList* words);
+void searchAnchorRows(Grid* grid, const LetterPositions* positions, const WordList* words,
+                      RowRange range, ProcessResults* results);
+void searchWordsAnchored(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results);
+
+#endif // ANCHOR_H
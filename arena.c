@@ -0,0 +1,102 @@
+#include "arena.h"
+#include "debug.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define ARENA_ALIGNMENT 16
+
+static size_t alignUp(size_t bytes) {
+    return (bytes + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+static ArenaBlock* ArenaBlock_create(size_t size) {
+    ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+    if (!block) return NULL;
+
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+Arena* Arena_create(size_t blockSize) {
+    Arena* arena = (Arena*)calloc(1, sizeof(Arena));
+    if (!arena) return NULL;
+
+    arena->blockSize = blockSize > 0 ? alignUp(blockSize) : ARENA_DEFAULT_BLOCK;
+    arena->head = ArenaBlock_create(arena->blockSize);
+    if (!arena->head) {
+        free(arena);
+        return NULL;
+    }
+    return arena;
+}
+
+void Arena_destroy(Arena* arena) {
+    if (!arena) return;
+
+    while (arena->head) {
+        ArenaBlock* next = arena->head->next;
+        free(arena->head);
+        arena->head = next;
+    }
+    free(arena);
+}
+
+// Keeps only the largest block, so a reused arena settles at its working size
+void Arena_reset(Arena* arena) {
+    ArenaBlock* keep = arena->head;
+    for (ArenaBlock* block = arena->head->next; block; block = block->next) {
+        if (block->size > keep->size) keep = block;
+    }
+
+    ArenaBlock* block = arena->head;
+    while (block) {
+        ArenaBlock* next = block->next;
+        if (block != keep) free(block);
+        block = next;
+    }
+
+    keep->next = NULL;
+    keep->used = 0;
+    arena->head = keep;
+    arena->last = NULL;
+}
+
+void* Arena_alloc(Arena* arena, size_t bytes) {
+    bytes = alignUp(bytes > 0 ? bytes : 1);
+
+    if (arena->head->used + bytes > arena->head->size) {
+        size_t size = bytes > arena->blockSize ? bytes : arena->blockSize;
+        ArenaBlock* block = ArenaBlock_create(size);
+        if (!block) return NULL;
+
+        block->next = arena->head;
+        arena->head = block;
+        debugPrint("DEBUG Arena: new block of %zu bytes\n", size);
+    }
+
+    void* memory = arena->head->data + arena->head->used;
+    arena->head->used += bytes;
+    arena->last = memory;
+    return memory;
+}
+
+// Resizes an allocation; the latest one is extended in place when its block
+// has room, anything else is copied to a new allocation
+void* Arena_grow(Arena* arena, void* old, size_t oldBytes, size_t newBytes) {
+    if (!old) return Arena_alloc(arena, newBytes);
+
+    ArenaBlock* head = arena->head;
+    if (old == arena->last) {
+        size_t start = (char*)old - head->data;
+        if (start + alignUp(newBytes) <= head->size) {
+            head->used = start + alignUp(newBytes);
+            return old;
+        }
+    }
+
+    void* memory = Arena_alloc(arena, newBytes);
+    if (memory) memcpy(memory, old, oldBytes < newBytes ? oldBytes : newBytes);
+    return memory;
+}
@@ -0,0 +1,30 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#define ARENA_DEFAULT_BLOCK (1 << 20)
+
+// Bump allocator over a chain of blocks. Allocations are never freed one by
+// one; the whole arena is reset or destroyed at once.
+typedef struct ArenaBlock {
+    struct ArenaBlock* next;
+    size_t size;
+    size_t used;
+    char data[];
+} ArenaBlock;
+
+typedef struct {
+    ArenaBlock* head;           // Block allocations come from
+    size_t blockSize;           // Minimum size of new blocks
+    void* last;                 // Most recent allocation, which can grow in place
+} Arena;
+
+Arena* Arena_create(size_t blockSize);
+void Arena_destroy(Arena* arena);
+void Arena_reset(Arena* arena);
+void* Arena_alloc(Arena* arena, size_t bytes);
+void* Arena_grow(Arena* arena, void* old, size_t oldBytes, size_t newBytes);
+
+#endif // ARENA_H
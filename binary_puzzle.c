@@ -0,0 +1,147 @@
+#include "binary_puzzle.h"
+#include "grid.h"
+#include "word_list.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + BINARY_PUZZLE_ALIGNMENT - 1) / BINARY_PUZZLE_ALIGNMENT * BINARY_PUZZLE_ALIGNMENT;
+}
+
+// True when length bytes at offset lie inside an input of size bytes
+static bool sectionFits(uint64_t offset, uint64_t length, size_t size) {
+    return offset <= size && length <= size - offset;
+}
+
+bool isBinaryPuzzle(const PuzzleInput* input) {
+    return input->size - input->pos >= 4 &&
+           memcmp(input->data + input->pos, BINARY_PUZZLE_MAGIC, 4) == 0;
+}
+
+// The grid is a view into the input, which must stay open while it is used
+Grid* readBinaryPuzzle(PuzzleInput* input, Arena* arena, WordList* words) {
+    const char* base = input->data + input->pos;
+    size_t size = input->size - input->pos;
+    BinaryPuzzleHeader header;
+
+    if (!isBinaryPuzzle(input)) return NULL;
+    if (size < sizeof(BinaryPuzzleHeader)) {
+        fprintf(stderr, "Error: Binary puzzle is truncated or corrupt\n");
+        return NULL;
+    }
+    memcpy(&header, base, sizeof(BinaryPuzzleHeader));
+
+    if (header.version != BINARY_PUZZLE_VERSION) {
+        fprintf(stderr, "Error: Unsupported binary puzzle version %u\n", header.version);
+        return NULL;
+    }
+    if (header.rows > INT_MAX || header.cols > INT_MAX || header.wordCount > INT_MAX ||
+        !sectionFits(header.gridOffset, (uint64_t)header.rows * header.cols, size) ||
+        !sectionFits(header.wordsOffset, header.wordBytes, size)) {
+        fprintf(stderr, "Error: Binary puzzle is truncated or corrupt\n");
+        return NULL;
+    }
+
+    Grid* grid = Grid_createView(header.rows, header.cols, base + header.gridOffset);
+    if (!grid) return NULL;
+
+    if (!WordList_unpack(words, arena, header.wordCount,
+                         base + header.wordsOffset, header.wordBytes)) {
+        fprintf(stderr, "Error: Binary puzzle has a corrupt word table\n");
+        Grid_destroy(grid);
+        return NULL;
+    }
+    input->pos = input->size;
+
+    debugPrint("DEBUG Binary: %u x %u grid, %u words, %u letters\n",
+               header.rows, header.cols, header.wordCount, header.alphabetSize);
+    return grid;
+}
+
+static bool writePadding(FILE* file, uint64_t bytes) {
+    static const char zeros[BINARY_PUZZLE_ALIGNMENT] = {0};
+    return fwrite(zeros, 1, bytes, file) == bytes;
+}
+
+bool writeBinaryPuzzle(const char* path, const Grid* grid, const WordList* words) {
+    BinaryPuzzleHeader header;
+    memset(&header, 0, sizeof(BinaryPuzzleHeader));
+    memcpy(header.magic, BINARY_PUZZLE_MAGIC, 4);
+    header.version = BINARY_PUZZLE_VERSION;
+    header.flags = BINARY_PUZZLE_FOLDED;
+    header.rows = grid->rows;
+    header.cols = grid->cols;
+    header.wordCount = words->count;
+    header.gridOffset = alignSection(sizeof(BinaryPuzzleHeader));
+    header.wordsOffset = alignSection(header.gridOffset + (uint64_t)grid->rows * grid->cols);
+    header.wordBytes = WordList_tableBytes(words);
+
+    char* row = (char*)malloc(grid->cols > 0 ? grid->cols : 1);
+    char* table = (char*)malloc(header.wordBytes > 0 ? header.wordBytes : 1);
+    FILE* file = fopen(path, "wb");
+    if (!row || !table || !file) {
+        free(row);
+        free(table);
+        if (file) fclose(file);
+        return false;
+    }
+
+    bool present[256] = {false};
+    for (int i = 0; i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            present[(unsigned char)tolower((unsigned char)grid->letters[i][j])] = true;
+        }
+    }
+    for (int c = 0; c < 256; c++) {
+        if (present[c]) header.alphabet[header.alphabetSize++] = (unsigned char)c;
+    }
+    WordList_pack(words, table);
+
+    bool written = fwrite(&header, sizeof(BinaryPuzzleHeader), 1, file) == 1 &&
+                   writePadding(file, header.gridOffset - sizeof(BinaryPuzzleHeader));
+    for (int i = 0; written && i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            row[j] = (char)tolower((unsigned char)grid->letters[i][j]);
+        }
+        written = fwrite(row, 1, grid->cols, file) == (size_t)grid->cols;
+    }
+    written = written &&
+              writePadding(file, header.wordsOffset - header.gridOffset -
+                                 (uint64_t)grid->rows * grid->cols) &&
+              fwrite(table, 1, header.wordBytes, file) == header.wordBytes;
+
+    free(row);
+    free(table);
+    return fclose(file) == 0 && written;
+}
+
+// Reads a puzzle in either format and writes it as a .wsb file
+bool convertPuzzle(const char* inputPath, const char* outputPath) {
+    PuzzleInput input;
+    WordList words;
+    Arena* arena = Arena_create(0);
+
+    if (!arena || !PuzzleInput_open(inputPath, &input)) {
+        fprintf(stderr, "Error: Failed to open puzzle %s\n", inputPath ? inputPath : "from stdin");
+        Arena_destroy(arena);
+        return false;
+    }
+
+    Grid* grid = readPuzzle(&input, arena, &words);
+    bool converted = grid && writeBinaryPuzzle(outputPath, grid, &words);
+    if (converted) {
+        printf("Wrote %s: %d columns x %d rows, %d words\n",
+               outputPath, grid->cols, grid->rows, words.count);
+    } else {
+        fprintf(stderr, "Error: Failed to convert puzzle to %s\n", outputPath);
+    }
+
+    Grid_destroy(grid);
+    PuzzleInput_close(&input);
+    Arena_destroy(arena);
+    return converted;
+}
@@ -0,0 +1,38 @@
+#ifndef BINARY_PUZZLE_H
+#define BINARY_PUZZLE_H
+
+#include "types.h"
+#include "file_io.h"
+#include <stdint.h>
+
+#define BINARY_PUZZLE_MAGIC "WSB1"
+#define BINARY_PUZZLE_VERSION 1
+
+// Sections start on this boundary so the grid can be used in place
+#define BINARY_PUZZLE_ALIGNMENT 64
+
+// Grid letters are stored lowercase
+#define BINARY_PUZZLE_FOLDED 0x1
+
+// Fixed header at the start of a .wsb file, in the writer's byte order. A
+// reader of the other byte order sees a wrong version and rejects the file.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t flags;
+    uint32_t rows;
+    uint32_t cols;
+    uint32_t wordCount;
+    uint64_t gridOffset;        // Row-major letters, rows * cols bytes
+    uint64_t wordsOffset;       // Word table, see WordList_pack
+    uint64_t wordBytes;
+    uint32_t alphabetSize;      // Distinct letters in the grid
+    unsigned char alphabet[256];    // Those letters, in ascending order
+} BinaryPuzzleHeader;
+
+bool isBinaryPuzzle(const PuzzleInput* input);
+Grid* readBinaryPuzzle(PuzzleInput* input, Arena* arena, WordList* words);
+bool writeBinaryPuzzle(const char* path, const Grid* grid, const WordList* words);
+bool convertPuzzle(const char* inputPath, const char* outputPath);
+
+#endif // BINARY_PUZZLE_H
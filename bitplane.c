@@ -0,0 +1,174 @@
+#include "bitplane.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static inline const uint64_t* planeRow(const LetterPlanes* planes, int plane, int row) {
+    return planes->bits + ((size_t)plane * planes->rowCount + (row - planes->firstRow))
+                          * planes->wordsPerRow;
+}
+
+// Word k of the row shifted so that bit x of the result is bit x + shift
+static inline uint64_t shiftedWord(const uint64_t* row, int words, int k, int shift) {
+    int source = k + (shift >> 6);
+    int bit = shift & 63;
+
+    uint64_t low = (source >= 0 && source < words) ? row[source] : 0;
+    if (bit == 0) return low;
+
+    uint64_t high = (source + 1 >= 0 && source + 1 < words) ? row[source + 1] : 0;
+    return (low >> bit) | (high << (64 - bit));
+}
+
+LetterPlanes* LetterPlanes_create(const Grid* grid, const WordList* words, RowRange range) {
+    LetterPlanes* planes = (LetterPlanes*)calloc(1, sizeof(LetterPlanes));
+    if (!planes) return NULL;
+
+    // Only letters that occur in some word need a plane
+    for (int w = 0; w < words->count; w++) {
+        for (const char* c = WordList_folded(words, w); *c; c++) {
+            unsigned char letter = (unsigned char)*c;
+            if (!planes->planes[letter]) {
+                planes->planes[letter] = (unsigned char)(++planes->planeCount);
+            }
+        }
+    }
+
+    planes->halo = grid->halo;
+    planes->firstRow = range.start - grid->halo;
+    planes->rowCount = (range.end - range.start) + 2 * grid->halo;
+    planes->wordsPerRow = (grid->stride + 63) / 64;
+    planes->bits = (uint64_t*)calloc((size_t)(planes->planeCount > 0 ? planes->planeCount : 1)
+                                     * planes->rowCount * planes->wordsPerRow, sizeof(uint64_t));
+    if (!planes->bits) {
+        LetterPlanes_destroy(planes);
+        return NULL;
+    }
+
+    for (int r = 0; r < planes->rowCount; r++) {
+        const char* cells = Grid_cellPtr(grid, planes->firstRow + r, -grid->halo);
+        for (int x = 0; x < grid->stride; x++) {
+            int plane = planes->planes[(unsigned char)cells[x]];
+            if (!plane) continue;
+
+            uint64_t* row = planes->bits + ((size_t)(plane - 1) * planes->rowCount + r)
+                                           * planes->wordsPerRow;
+            row[x >> 6] |= 1ULL << (x & 63);
+        }
+    }
+
+    debugPrint("DEBUG Bitplane: %d planes, %d rows, %d words per row\n",
+               planes->planeCount, planes->rowCount, planes->wordsPerRow);
+    return planes;
+}
+
+void LetterPlanes_destroy(LetterPlanes* planes) {
+    if (!planes) return;
+
+    free(planes->bits);
+    free(planes);
+}
+
+// Matches the words starting in range against planes built beforehand
+// over range or a band containing it, so the row blocks of one search can
+// share them
+void searchPlaneRows(Grid* grid, const LetterPlanes* planes, const WordList* words,
+                     RowRange range, ProcessResults* results) {
+    int longest = words->longest;
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+    if (longest == 0 || range.start >= range.end) return;
+
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    uint64_t* match = (uint64_t*)malloc(planes->wordsPerRow * sizeof(uint64_t));
+    int* letterPlanes = (int*)malloc(longest * sizeof(int));
+    bool ok = hits && match && letterPlanes;
+
+    // Output bits are the padded columns [halo, halo + cols)
+    int halo = grid->halo;
+    int firstWord = halo >> 6;
+    int lastWord = (halo + grid->cols - 1) >> 6;
+
+    for (int w = 0; w < words->count && ok; w++) {
+        const char* folded = WordList_folded(words, w);
+        int len = WordList_length(words, w);
+        if (len == 0) continue;
+
+        for (int i = 0; i < len; i++) {
+            letterPlanes[i] = planes->planes[(unsigned char)folded[i]] - 1;
+        }
+
+        for (Direction dir = 0; dir < DIRECTIONS_COUNT && ok; dir++) {
+            DirectionVector vector = DIRECTION_VECTORS[dir];
+
+            for (int r = range.start; r < range.end && ok; r++) {
+                // match = AND over i of plane(word[i]) moved back by i steps
+                bool any = false;
+                for (int k = firstWord; k <= lastWord; k++) {
+                    match[k] = planeRow(planes, letterPlanes[0], r)[k];
+                    any |= match[k] != 0;
+                }
+
+                for (int i = 1; i < len && any; i++) {
+                    const uint64_t* row = planeRow(planes, letterPlanes[i], r + i * vector.dx);
+                    any = false;
+                    for (int k = firstWord; k <= lastWord; k++) {
+                        match[k] &= shiftedWord(row, planes->wordsPerRow, k, i * vector.dy);
+                        any |= match[k] != 0;
+                    }
+                }
+                if (!any) continue;
+
+                for (int k = firstWord; k <= lastWord && ok; k++) {
+                    for (uint64_t bits = match[k]; bits && ok; bits &= bits - 1) {
+                        int col = k * 64 + __builtin_ctzll(bits) - halo;
+                        if (col < 0 || col >= grid->cols) continue;
+                        ok = pushSearchHit(&hits, &numHits, &hitCapacity,
+                                           (SearchHit){w, r, col, dir});
+                    }
+                }
+            }
+        }
+    }
+
+    free(letterPlanes);
+    free(match);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for bitplane search\n");
+        free(hits);
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    appendSortedHits(grid, words, hits, numHits, results);
+    debugPrint("Bitplane search found %d matches in rows %d to %d\n",
+               numHits, range.start, range.end - 1);
+
+    free(hits);
+}
+
+void searchWordsBitplane(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results) {
+    if (words->longest == 0 || range.start >= range.end) {
+        if (words->count > results->totalProcessed) {
+            results->totalProcessed = words->count;
+        }
+        return;
+    }
+
+    LetterPlanes* planes = Grid_ensureSearchLayout(grid, words->longest - 1)
+                           ? LetterPlanes_create(grid, words, range) : NULL;
+    if (searchWordsFallback(grid, words, range, results, planes != NULL)) return;
+
+    searchPlaneRows(grid, planes, words, range, results);
+    LetterPlanes_destroy(planes);
+}
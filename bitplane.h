@@ -0,0 +1,29 @@
+#ifndef BITPLANE_H
+#define BITPLANE_H
+
+#include "types.h"
+#include "grid.h"
+#include <stdint.h>
+
+// One bit plane per letter of the dictionary alphabet (26 for a-z words).
+// Plane rows cover the padded layout rows [start - halo, end + halo) and
+// padded columns [-halo, cols + halo), so torus wrap is already baked in and
+// every shift is a plain bit shift.
+typedef struct {
+    uint64_t* bits;             // planeCount x rowCount x wordsPerRow
+    int planeCount;
+    int rowCount;
+    int wordsPerRow;
+    int firstRow;               // Grid row of plane row 0
+    int halo;
+    unsigned char planes[256];  // Byte -> plane + 1, 0 when unused
+} LetterPlanes;
+
+LetterPlanes* LetterPlanes_create(const Grid* grid, const WordList* words, RowRange range);
+void LetterPlanes_destroy(LetterPlanes* planes);
+void searchPlaneRows(Grid* grid, const LetterPlanes* planes, const WordList* words,
+                     RowRange range, ProcessResults* results);
+void searchWordsBitplane(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results);
+
+#endif // BITPLANE_H
@@ -17,3 +17,37 @@ const DirectionVector DIRECTION_VECTORS[DIRECTIONS_COUNT] = {
     { 1, -1, "DOWN_LEFT"},
     { 1,  1, "DOWN_RIGHT"}
 };
+
+// Directions that walk down or to the right, each with its opposite, which
+// reads the same cells backwards
+const Direction FORWARD_DIRECTIONS[FORWARD_DIRECTIONS_COUNT][2] = {
+    {DIR_RIGHT, DIR_LEFT},
+    {DIR_DOWN, DIR_UP},
+    {DIR_DOWN_RIGHT, DIR_UP_LEFT},
+    {DIR_DOWN_LEFT, DIR_UP_RIGHT}
+};
+
+const char* const SEARCH_ENGINE_NAMES[SEARCH_ENGINES_COUNT] = {
+    "brute",
+    "trie",
+    "lines",
+    "bitplane",
+    "index",
+    "rolling",
+    "anchor",
+    "folded"
+};
+
+const char* const SCHEDULE_NAMES[SCHEDULES_COUNT] = {
+    "static",
+    "steal"
+};
+
+const char* const DISTRIBUTION_NAMES[DISTRIBUTIONS_COUNT] = {
+    "static",
+    "dynamic",
+    "tiles",
+    "words",
+    "hybrid",
+    "auto"
+};
@@ -5,5 +5,9 @@
 
 extern const ColorCodes COLORS;
 extern const DirectionVector DIRECTION_VECTORS[DIRECTIONS_COUNT];
+extern const Direction FORWARD_DIRECTIONS[FORWARD_DIRECTIONS_COUNT][2];
+extern const char* const SEARCH_ENGINE_NAMES[SEARCH_ENGINES_COUNT];
+extern const char* const SCHEDULE_NAMES[SCHEDULES_COUNT];
+extern const char* const DISTRIBUTION_NAMES[DISTRIBUTIONS_COUNT];
 
 #endif // CONSTANTS_H
@@ -0,0 +1,336 @@
+#include "dictionary.h"
+#include "file_io.h"
+#include "word_list.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+typedef struct {
+    const char* folded;
+    int index;
+} SortEntry;
+
+static uint64_t alignSection(uint64_t offset) {
+    return (offset + DICTIONARY_ALIGNMENT - 1) / DICTIONARY_ALIGNMENT * DICTIONARY_ALIGNMENT;
+}
+
+// True when length bytes at offset lie inside a file of size bytes and
+// start on a section boundary
+static bool sectionFits(uint64_t offset, uint64_t length, size_t size) {
+    return offset % DICTIONARY_ALIGNMENT == 0 && offset <= size && length <= size - offset;
+}
+
+static bool isIndexOrNone(int value, uint32_t count) {
+    return value == -1 || (value >= 0 && (uint32_t)value < count);
+}
+
+// Checks every index the search and lookups will follow, so a corrupt file
+// cannot send them outside the mapping
+static bool validateDictionary(const DictionaryHeader* header, const char* base, size_t size) {
+    uint64_t words = header->wordCount;
+    uint64_t nodes = header->nodeCount;
+    if (header->offsetBytes != sizeof(size_t) || header->wordCount > INT_MAX ||
+        header->nodeCount == 0 || header->nodeCount > INT_MAX ||
+        header->alphabetSize == 0 || header->alphabetSize > 256 ||
+        !sectionFits(header->textOffset, header->poolBytes, size) ||
+        !sectionFits(header->foldedOffset, header->poolBytes, size) ||
+        !sectionFits(header->offsetsOffset, words * sizeof(size_t), size) ||
+        !sectionFits(header->lengthsOffset, words * sizeof(int), size) ||
+        !sectionFits(header->sortedOffset, words * sizeof(int), size) ||
+        !sectionFits(header->childrenOffset, nodes * header->alphabetSize * sizeof(int), size) ||
+        !sectionFits(header->firstWordOffset, nodes * sizeof(int), size) ||
+        !sectionFits(header->nextWordOffset, words * sizeof(int), size)) {
+        return false;
+    }
+
+    const char* text = base + header->textOffset;
+    const char* folded = base + header->foldedOffset;
+    const size_t* offsets = (const size_t*)(base + header->offsetsOffset);
+    const int* lengths = (const int*)(base + header->lengthsOffset);
+    const int* sorted = (const int*)(base + header->sortedOffset);
+    const int* nextWord = (const int*)(base + header->nextWordOffset);
+    int longest = 0;
+
+    for (uint32_t w = 0; w < header->wordCount; w++) {
+        if (lengths[w] < 0 || offsets[w] >= header->poolBytes ||
+            (uint64_t)lengths[w] >= header->poolBytes - offsets[w] ||
+            text[offsets[w] + lengths[w]] != '\0' || folded[offsets[w] + lengths[w]] != '\0' ||
+            !isIndexOrNone(sorted[w], header->wordCount) || sorted[w] < 0 ||
+            // Word chains only move forward, so they always end
+            !isIndexOrNone(nextWord[w], header->wordCount) ||
+            (nextWord[w] >= 0 && (uint32_t)nextWord[w] <= w)) {
+            return false;
+        }
+        if (lengths[w] > longest) longest = lengths[w];
+    }
+    if ((uint32_t)longest != header->longest) return false;
+
+    for (int c = 0; c < 256; c++) {
+        if (header->symbols[c] > header->alphabetSize) return false;
+    }
+
+    const int* children = (const int*)(base + header->childrenOffset);
+    const int* firstWord = (const int*)(base + header->firstWordOffset);
+    for (uint64_t i = 0; i < nodes * header->alphabetSize; i++) {
+        if (!isIndexOrNone(children[i], header->nodeCount)) return false;
+    }
+    for (uint64_t node = 0; node < nodes; node++) {
+        if (!isIndexOrNone(firstWord[node], header->wordCount)) return false;
+    }
+    return true;
+}
+
+// Maps a dictionary written by compileDictionary. Nothing is copied or
+// rebuilt: the word list and trie are views into the mapping.
+bool Dictionary_open(const char* path, Dictionary* dictionary) {
+    memset(dictionary, 0, sizeof(Dictionary));
+
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        fprintf(stderr, "Error: Failed to open dictionary %s\n", path);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+
+    size_t size = info.st_size;
+    void* mapping = size >= sizeof(DictionaryHeader)
+                    ? mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Error: Dictionary %s is truncated or cannot be mapped\n", path);
+        return false;
+    }
+
+    const char* base = (const char*)mapping;
+    const DictionaryHeader* header = (const DictionaryHeader*)base;
+    if (memcmp(header->magic, DICTIONARY_MAGIC, 4) != 0 ||
+        header->version != DICTIONARY_VERSION) {
+        fprintf(stderr, "Error: %s is not a version %d dictionary\n", path, DICTIONARY_VERSION);
+        munmap(mapping, size);
+        return false;
+    }
+    if (!validateDictionary(header, base, size)) {
+        fprintf(stderr, "Error: Dictionary %s is truncated or corrupt\n", path);
+        munmap(mapping, size);
+        return false;
+    }
+
+    Trie* trie = (Trie*)calloc(1, sizeof(Trie));
+    if (!trie) {
+        munmap(mapping, size);
+        return false;
+    }
+    trie->children = (int*)(base + header->childrenOffset);
+    trie->firstWord = (int*)(base + header->firstWordOffset);
+    trie->nextWord = (int*)(base + header->nextWordOffset);
+    trie->nodeCount = header->nodeCount;
+    trie->nodeCapacity = header->nodeCount;
+    trie->alphabetSize = header->alphabetSize;
+    trie->maxDepth = header->longest;
+    memcpy(trie->symbols, header->symbols, sizeof(trie->symbols));
+
+    dictionary->mapping = mapping;
+    dictionary->size = size;
+    dictionary->sorted = (const int*)(base + header->sortedOffset);
+    dictionary->trie = trie;
+    dictionary->words = (WordList){
+        .text = (char*)(base + header->textOffset),
+        .folded = (char*)(base + header->foldedOffset),
+        .offsets = (size_t*)(base + header->offsetsOffset),
+        .lengths = (int*)(base + header->lengthsOffset),
+        .count = header->wordCount,
+        .longest = header->longest,
+        .trie = trie
+    };
+
+    debugPrint("DEBUG Dictionary: %u words, %u trie nodes, %zu bytes mapped\n",
+               header->wordCount, header->nodeCount, size);
+    return true;
+}
+
+void Dictionary_close(Dictionary* dictionary) {
+    if (dictionary->mapping) munmap(dictionary->mapping, dictionary->size);
+    free(dictionary->trie);
+    memset(dictionary, 0, sizeof(Dictionary));
+}
+
+// Orders the folded word against word, compared case-insensitively
+static int compareFolded(const char* folded, const char* word, int len) {
+    for (int i = 0; i < len; i++) {
+        int letter = tolower((unsigned char)word[i]);
+        if ((unsigned char)folded[i] != letter) return (unsigned char)folded[i] - letter;
+    }
+    return (unsigned char)folded[len];
+}
+
+// Index of word in the dictionary, ignoring case, or -1. A binary search
+// of the sorted table.
+int Dictionary_lookup(const Dictionary* dictionary, const char* word, int len) {
+    int low = 0;
+    int high = dictionary->words.count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        int index = dictionary->sorted[middle];
+        int order = compareFolded(WordList_folded(&dictionary->words, index), word, len);
+        if (order == 0) return index;
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+static int compareEntries(const void* a, const void* b) {
+    const SortEntry* left = (const SortEntry*)a;
+    const SortEntry* right = (const SortEntry*)b;
+    int order = strcmp(left->folded, right->folded);
+    return order != 0 ? order : left->index - right->index;
+}
+
+// Pads the file up to offset, then writes bytes of data there
+static bool writeSection(FILE* file, uint64_t* position, uint64_t offset,
+                         const void* data, size_t bytes) {
+    static const char zeros[DICTIONARY_ALIGNMENT] = {0};
+    if (fwrite(zeros, 1, offset - *position, file) != offset - *position ||
+        fwrite(data, 1, bytes, file) != bytes) {
+        return false;
+    }
+    *position = offset + bytes;
+    return true;
+}
+
+static bool writeDictionary(const char* path, const WordList* words, const int* sorted,
+                            const Trie* trie) {
+    DictionaryHeader header;
+    memset(&header, 0, sizeof(DictionaryHeader));
+    memcpy(header.magic, DICTIONARY_MAGIC, 4);
+    header.version = DICTIONARY_VERSION;
+    header.offsetBytes = sizeof(size_t);
+    header.wordCount = words->count;
+    header.longest = words->longest;
+    header.nodeCount = trie->nodeCount;
+    header.alphabetSize = trie->alphabetSize;
+    header.poolBytes = words->count > 0 ? words->offsets[words->count - 1] +
+                                          words->lengths[words->count - 1] + 1 : 0;
+    memcpy(header.symbols, trie->symbols, sizeof(header.symbols));
+
+    uint64_t wordInts = (uint64_t)words->count * sizeof(int);
+    uint64_t childBytes = (uint64_t)trie->nodeCount * trie->alphabetSize * sizeof(int);
+    header.textOffset = alignSection(sizeof(DictionaryHeader));
+    header.foldedOffset = alignSection(header.textOffset + header.poolBytes);
+    header.offsetsOffset = alignSection(header.foldedOffset + header.poolBytes);
+    header.lengthsOffset = alignSection(header.offsetsOffset + words->count * sizeof(size_t));
+    header.sortedOffset = alignSection(header.lengthsOffset + wordInts);
+    header.childrenOffset = alignSection(header.sortedOffset + wordInts);
+    header.firstWordOffset = alignSection(header.childrenOffset + childBytes);
+    header.nextWordOffset = alignSection(header.firstWordOffset +
+                                         (uint64_t)trie->nodeCount * sizeof(int));
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    uint64_t position = 0;
+    bool written =
+        writeSection(file, &position, 0, &header, sizeof(DictionaryHeader)) &&
+        writeSection(file, &position, header.textOffset, words->text, header.poolBytes) &&
+        writeSection(file, &position, header.foldedOffset, words->folded, header.poolBytes) &&
+        writeSection(file, &position, header.offsetsOffset, words->offsets,
+                     words->count * sizeof(size_t)) &&
+        writeSection(file, &position, header.lengthsOffset, words->lengths, wordInts) &&
+        writeSection(file, &position, header.sortedOffset, sorted, wordInts) &&
+        writeSection(file, &position, header.childrenOffset, trie->children, childBytes) &&
+        writeSection(file, &position, header.firstWordOffset, trie->firstWord,
+                     (size_t)trie->nodeCount * sizeof(int)) &&
+        writeSection(file, &position, header.nextWordOffset, trie->nextWord, wordInts);
+
+    return fclose(file) == 0 && written;
+}
+
+// Copies the words of all into words without repeats (ignoring case,
+// keeping the first), and fills sorted with their indices in folded order
+static bool uniqueWords(const WordList* all, Arena* arena, WordList* words, int* sorted) {
+    SortEntry* entries = (SortEntry*)malloc((all->count > 0 ? all->count : 1) * sizeof(SortEntry));
+    int* newIndex = (int*)malloc((all->count > 0 ? all->count : 1) * sizeof(int));
+    if (!entries || !newIndex) {
+        free(entries);
+        free(newIndex);
+        return false;
+    }
+
+    // Sorting by folded text puts repeats right after their first occurrence
+    for (int i = 0; i < all->count; i++) {
+        entries[i] = (SortEntry){WordList_folded(all, i), i};
+        newIndex[i] = -1;
+    }
+    qsort(entries, all->count, sizeof(SortEntry), compareEntries);
+
+    int count = 0;
+    size_t letters = 0;
+    for (int i = 0; i < all->count; i++) {
+        if (i > 0 && strcmp(entries[i].folded, entries[i - 1].folded) == 0) continue;
+        newIndex[entries[i].index] = 0;
+        letters += WordList_length(all, entries[i].index);
+        count++;
+    }
+
+    // Kept words stay in input order
+    bool built = WordList_init(words, arena, count, letters);
+    for (int i = 0, next = 0; built && i < all->count; i++) {
+        if (newIndex[i] < 0) continue;
+        newIndex[i] = next++;
+        WordList_set(words, newIndex[i], WordList_word(all, i), WordList_length(all, i));
+    }
+    for (int i = 0, next = 0; built && i < all->count; i++) {
+        if (newIndex[entries[i].index] >= 0 &&
+            (i == 0 || strcmp(entries[i].folded, entries[i - 1].folded) != 0)) {
+            sorted[next++] = newIndex[entries[i].index];
+        }
+    }
+
+    free(entries);
+    free(newIndex);
+    return built;
+}
+
+// Reads a word list and writes its distinct words, their sorted order and
+// their trie as a .wsd file
+bool compileDictionary(const char* inputPath, const char* outputPath) {
+    PuzzleInput input;
+    WordList all;
+    WordList words;
+    Arena* arena = Arena_create(0);
+
+    if (!arena || !PuzzleInput_open(inputPath, &input)) {
+        fprintf(stderr, "Error: Failed to open word list %s\n", inputPath ? inputPath : "from stdin");
+        Arena_destroy(arena);
+        return false;
+    }
+
+    bool read = readWordList(&input, arena, &all);
+    int* sorted = read ? (int*)malloc((all.count > 0 ? all.count : 1) * sizeof(int)) : NULL;
+    Trie* trie = sorted && uniqueWords(&all, arena, &words, sorted) ? Trie_create(&words) : NULL;
+
+    bool compiled = trie && writeDictionary(outputPath, &words, sorted, trie);
+    if (compiled) {
+        printf("Wrote %s: %d words (%d repeats dropped), %d trie nodes\n",
+               outputPath, words.count, all.count - words.count, trie->nodeCount);
+    } else {
+        fprintf(stderr, "Error: Failed to compile dictionary %s\n", outputPath);
+    }
+
+    Trie_destroy(trie);
+    free(sorted);
+    PuzzleInput_close(&input);
+    Arena_destroy(arena);
+    return compiled;
+}
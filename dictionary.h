@@ -0,0 +1,52 @@
+#ifndef DICTIONARY_H
+#define DICTIONARY_H
+
+#include "types.h"
+#include "trie.h"
+#include <stdint.h>
+
+#define DICTIONARY_MAGIC "WSD1"
+#define DICTIONARY_VERSION 1
+
+// Sections start on this boundary so the arrays can be used in place
+#define DICTIONARY_ALIGNMENT 64
+
+// Fixed header at the start of a .wsd file, in the writer's byte order and
+// size_t width. A reader that differs in either rejects the file.
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t offsetBytes;       // sizeof(size_t) of the writer
+    uint32_t wordCount;
+    uint32_t longest;
+    uint32_t nodeCount;
+    uint32_t alphabetSize;
+    uint32_t reserved;
+    uint64_t poolBytes;         // Size of the text and of the folded pool
+    uint64_t textOffset;        // Words as given, each NUL-terminated
+    uint64_t foldedOffset;      // Lowercase copy, same layout
+    uint64_t offsetsOffset;     // size_t start of each word in the pools
+    uint64_t lengthsOffset;     // int length of each word
+    uint64_t sortedOffset;      // int word indices in folded byte order
+    uint64_t childrenOffset;    // Trie child table, nodeCount x alphabetSize ints
+    uint64_t firstWordOffset;   // int per node
+    uint64_t nextWordOffset;    // int per word
+    unsigned char symbols[256]; // Trie symbol table
+} DictionaryHeader;
+
+// A compiled dictionary mapped read-only. The word list and trie point into
+// the mapping, so processes on one node share its pages.
+typedef struct {
+    void* mapping;
+    size_t size;
+    const int* sorted;
+    Trie* trie;             // Heap view over the mapped trie arrays
+    WordList words;         // Carries trie for the trie engine
+} Dictionary;
+
+bool Dictionary_open(const char* path, Dictionary* dictionary);
+void Dictionary_close(Dictionary* dictionary);
+int Dictionary_lookup(const Dictionary* dictionary, const char* word, int len);
+bool compileDictionary(const char* inputPath, const char* outputPath);
+
+#endif // DICTIONARY_H
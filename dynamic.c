@@ -0,0 +1,86 @@
+#include "dynamic.h"
+#include "search.h"
+#include "debug.h"
+#include <stdio.h>
+
+// Smallest chunk as a fraction of a static slab; keeps the request count
+// bounded on tall grids
+#define MIN_CHUNKS_PER_PROCESS 64
+
+// Guided scheduling: half of the remaining rows' fair share per request,
+// shrinking towards minChunk as the grid runs out
+RowRange nextGuidedChunk(int* nextRow, int totalRows, int size, int minChunk) {
+    int remaining = totalRows - *nextRow;
+    int chunk = (remaining + 2 * size - 1) / (2 * size);
+    if (chunk < minChunk) chunk = minChunk;
+    if (chunk > remaining) chunk = remaining;
+
+    RowRange rows = {*nextRow, *nextRow + chunk};
+    *nextRow += chunk;
+    return rows;
+}
+
+static void addChunk(ProcessResults* results, ChunkStats* stats, RowRange rows,
+                     RowSearchFn search, void* context) {
+    search(rows, context, results);
+
+    stats->chunks++;
+    stats->rows += rows.end - rows.start;
+}
+
+void coordinateDynamicRows(MPI_Comm comm, int size, int totalRows, RowSearchFn search,
+                           void* context, ChunkStats* stats, ProcessResults* results) {
+    int minChunk = totalRows / (size * MIN_CHUNKS_PER_PROCESS);
+    if (minChunk < 1) minChunk = 1;
+
+    int nextRow = 0;
+    int activeWorkers = size - 1;
+
+    while (activeWorkers > 0 || nextRow < totalRows) {
+        int pending = 0;
+        MPI_Status status;
+        MPI_Iprobe(MPI_ANY_SOURCE, TAG_CHUNK_REQUEST, comm, &pending, &status);
+
+        if (pending || nextRow >= totalRows) {
+            // Answer a worker; an empty range tells it to stop
+            int request;
+            MPI_Recv(&request, 1, MPI_INT, MPI_ANY_SOURCE, TAG_CHUNK_REQUEST,
+                     comm, &status);
+
+            RowRange rows = {totalRows, totalRows};
+            if (nextRow < totalRows) {
+                rows = nextGuidedChunk(&nextRow, totalRows, size, minChunk);
+            } else {
+                activeWorkers--;
+            }
+            MPI_Send(&rows, 2, MPI_INT, status.MPI_SOURCE, TAG_CHUNK_ASSIGN, comm);
+
+            debugPrint("DEBUG Dynamic: rows %d to %d to process %d\n",
+                       rows.start, rows.end - 1, status.MPI_SOURCE);
+            continue;
+        }
+
+        // No request waiting: search a minimal chunk locally so replies stay prompt
+        RowRange rows = {nextRow, nextRow + (activeWorkers > 0 ? minChunk : totalRows)};
+        if (rows.end > totalRows) rows.end = totalRows;
+        nextRow = rows.end;
+        addChunk(results, stats, rows, search, context);
+    }
+
+    sortResultsInWordOrder(results);
+}
+
+void requestDynamicRows(MPI_Comm comm, RowSearchFn search, void* context, ChunkStats* stats,
+                        ProcessResults* results) {
+    for (;;) {
+        int request = 0;
+        RowRange rows;
+        MPI_Send(&request, 1, MPI_INT, 0, TAG_CHUNK_REQUEST, comm);
+        MPI_Recv(&rows, 2, MPI_INT, 0, TAG_CHUNK_ASSIGN, comm, MPI_STATUS_IGNORE);
+
+        if (rows.start >= rows.end) break;
+        addChunk(results, stats, rows, search, context);
+    }
+
+    sortResultsInWordOrder(results);
+}
@@ -0,0 +1,19 @@
+#ifndef DYNAMIC_H
+#define DYNAMIC_H
+
+#include "types.h"
+#include <mpi.h>
+
+#define TAG_CHUNK_REQUEST 101
+#define TAG_CHUNK_ASSIGN 102
+
+// Searches one chunk of rows on the calling process, appending to results
+typedef void (*RowSearchFn)(RowRange rows, void* context, ProcessResults* results);
+
+RowRange nextGuidedChunk(int* nextRow, int totalRows, int size, int minChunk);
+void coordinateDynamicRows(MPI_Comm comm, int size, int totalRows, RowSearchFn search,
+                           void* context, ChunkStats* stats, ProcessResults* results);
+void requestDynamicRows(MPI_Comm comm, RowSearchFn search, void* context, ChunkStats* stats,
+                        ProcessResults* results);
+
+#endif // DYNAMIC_H
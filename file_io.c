@@ -1,113 +1,359 @@
+#define _GNU_SOURCE
 #include "file_io.h"
+#include "binary_puzzle.h"
 #include "debug.h"
+#include "word_list.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
-static int countTokens(const char* str) {
-    int count = 0;
-    char* copy = strdup(str);
-    if (!copy) return 0;
+// Line that introduces the word list
+#define WORDS_MARKER "Palavras:"
 
-    char* token = strtok(copy, " \t\n");
-    while (token != NULL) {
-        if (strlen(token) > 0) count++;
-        token = strtok(NULL, " \t\n");
-    }
+// Line that separates the puzzles of a batch input
+#define DOCUMENT_DELIMITER "---"
 
-    free(copy);
-    return count;
-}
+// First read size for inputs that cannot be mapped; doubled as they grow
+#define STREAM_BUFFER_BYTES (1 << 16)
 
-Grid* readPuzzleFromFile(void) {
-    char** lines = NULL;
-    int capacity = INITIAL_GRID_CAPACITY;
-    int numLines = 0;
-    char line[MAX_LINE_LENGTH];
-    int maxCols = 0;
+// Maps a regular file, starting at the descriptor's current offset so a
+// redirected stdin is read from where it stands
+static bool mapInput(int fd, PuzzleInput* input) {
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) return false;
 
-    lines = (char**)malloc(capacity * sizeof(char*));
-    if (!lines) return NULL;
+    off_t offset = lseek(fd, 0, SEEK_CUR);
+    if (offset < 0 || offset > info.st_size) offset = 0;
+    if (info.st_size == 0) {
+        input->data = "";
+        return true;
+    }
 
-    while (fgets(line, MAX_LINE_LENGTH, stdin)) {
-        line[strcspn(line, "\n")] = 0;
+    void* mapping = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) return false;
+    posix_madvise(mapping, info.st_size, POSIX_MADV_SEQUENTIAL);
 
-        if (strlen(line) == 0 || strstr(line, "Palavras:") != NULL) {
-            break;
-        }
+    input->mapping = mapping;
+    input->mappedSize = info.st_size;
+    input->data = (const char*)mapping + offset;
+    input->size = info.st_size - offset;
+    return true;
+}
 
-        if (numLines >= capacity) {
-            capacity *= 2;
-            char** temp = realloc(lines, capacity * sizeof(char*));
+// Reads pipes and terminals to the end in large blocks
+static bool readStream(int fd, PuzzleInput* input) {
+    size_t capacity = STREAM_BUFFER_BYTES;
+    size_t size = 0;
+    char* buffer = (char*)malloc(capacity);
+    if (!buffer) return false;
+
+    for (;;) {
+        if (size == capacity) {
+            char* temp = (char*)realloc(buffer, capacity * 2);
             if (!temp) {
-                for (int i = 0; i < numLines; i++) {
-                    free(lines[i]);
-                }
-                free(lines);
-                return NULL;
+                free(buffer);
+                return false;
             }
-            lines = temp;
+            buffer = temp;
+            capacity *= 2;
         }
 
-        lines[numLines] = strdup(line);
-        if (!lines[numLines]) {
-            for (int i = 0; i < numLines; i++) {
-                free(lines[i]);
-            }
-            free(lines);
-            return NULL;
+        ssize_t got = read(fd, buffer + size, capacity - size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0) {
+            free(buffer);
+            return false;
         }
+        if (got == 0) break;
+        size += got;
+    }
+
+    input->buffer = buffer;
+    input->data = buffer;
+    input->size = size;
+    return true;
+}
+
+bool PuzzleInput_open(const char* path, PuzzleInput* input) {
+    memset(input, 0, sizeof(PuzzleInput));
+
+    int fd = path ? open(path, O_RDONLY) : STDIN_FILENO;
+    if (fd < 0) return false;
+
+    bool opened = mapInput(fd, input) || readStream(fd, input);
+    if (path) close(fd);
 
-        int cols = countTokens(line);
-        if (cols > maxCols) maxCols = cols;
+    debugPrint("DEBUG Input: %zu bytes %s\n", input->size,
+               input->mapping ? "mapped" : "streamed");
+    return opened;
+}
+
+void PuzzleInput_close(PuzzleInput* input) {
+    if (input->mapping) munmap(input->mapping, input->mappedSize);
+    free(input->buffer);
+    memset(input, 0, sizeof(PuzzleInput));
+}
+
+// Offset just past the last character of the line starting at pos
+static size_t lineEnd(const PuzzleInput* input, size_t pos) {
+    const char* newline = (const char*)memchr(input->data + pos, '\n', input->size - pos);
+    return newline ? (size_t)(newline - input->data) : input->size;
+}
 
-        numLines++;
+static size_t nextLine(const PuzzleInput* input, size_t end) {
+    return end < input->size ? end + 1 : end;
+}
+
+// Counts the cells of one grid row and, when row is not NULL, writes them.
+// A row with whitespace between its letters is spaced, one cell per token
+// (its first character); a row without is compact, one cell per character.
+static int scanRow(const char* c, const char* end, char* row) {
+    const char* first = NULL;
+    int firstLength = 0;
+    int tokens = 0;
+
+    while (c < end) {
+        while (c < end && isspace((unsigned char)*c)) c++;
+        if (c == end) break;
+
+        const char* token = c;
+        while (c < end && !isspace((unsigned char)*c)) c++;
+        if (row) row[tokens] = *token;
+        if (tokens++ == 0) {
+            first = token;
+            firstLength = c - token;
+        }
     }
 
-    Grid* grid = Grid_create(numLines, maxCols);
-    if (!grid) {
-        for (int i = 0; i < numLines; i++) {
-            free(lines[i]);
+    if (tokens != 1) return tokens;
+    if (row) memcpy(row, first, firstLength);
+    return firstLength;
+}
+
+static bool isWordsMarker(const char* line, size_t length) {
+    return memmem(line, length, WORDS_MARKER, sizeof(WORDS_MARKER) - 1) != NULL;
+}
+
+// Trims whitespace from both ends of line in place
+static void trimLine(const char** line, size_t* length) {
+    while (*length > 0 && isspace((unsigned char)(*line)[*length - 1])) (*length)--;
+    while (*length > 0 && isspace((unsigned char)**line)) {
+        (*line)++;
+        (*length)--;
+    }
+}
+
+static bool isDelimiter(const char* line, size_t length) {
+    trimLine(&line, &length);
+    return length == sizeof(DOCUMENT_DELIMITER) - 1 &&
+           memcmp(line, DOCUMENT_DELIMITER, length) == 0;
+}
+
+Grid* readPuzzleFromFile(PuzzleInput* input) {
+    // First pass finds the dimensions; the grid ends at a blank line or
+    // the word list marker
+    size_t start = input->pos;
+    size_t pos = start;
+    int rows = 0;
+    int cols = 0;
+
+    while (pos < input->size) {
+        size_t end = lineEnd(input, pos);
+        int cells = scanRow(input->data + pos, input->data + end, NULL);
+        if (cells == 0 || isWordsMarker(input->data + pos, end - pos) ||
+            isDelimiter(input->data + pos, end - pos)) {
+            break;
         }
-        free(lines);
-        return NULL;
+
+        if (cells > cols) cols = cells;
+        rows++;
+        pos = nextLine(input, end);
+    }
+
+    Grid* grid = Grid_create(rows, cols);
+    if (!grid) return NULL;
+
+    // Second pass writes the letters straight into the grid
+    pos = start;
+    for (int i = 0; i < rows; i++) {
+        size_t end = lineEnd(input, pos);
+        scanRow(input->data + pos, input->data + end, grid->letters[i]);
+        pos = nextLine(input, end);
     }
+    input->pos = pos;
 
-    for (int i = 0; i < numLines; i++) {
-        char* token = strtok(lines[i], " \t\n");
-        int j = 0;
-        while (token != NULL && j < maxCols) {
-            grid->letters[i][j] = token[0];
-            j++;
-            token = strtok(NULL, " \t\n");
+    return grid;
+}
+
+// Word separators on the word list line
+static bool isWordSeparator(char c) {
+    return c == ',' || isspace((unsigned char)c);
+}
+
+// Words between begin and end. First pass sizes the pool, second pass
+// fills it.
+static bool parseWords(const char* begin, const char* end, Arena* arena, WordList* words) {
+    int count = 0;
+    size_t letters = 0;
+    for (const char* c = begin; c < end; ) {
+        while (c < end && isWordSeparator(*c)) c++;
+        if (c == end) break;
+
+        const char* start = c;
+        while (c < end && !isWordSeparator(*c)) c++;
+        letters += c - start;
+        count++;
+    }
+
+    if (!WordList_init(words, arena, count, letters)) {
+        return false;
+    }
+
+    int index = 0;
+    for (const char* c = begin; c < end; ) {
+        while (c < end && isWordSeparator(*c)) c++;
+        if (c == end) break;
+
+        const char* start = c;
+        while (c < end && !isWordSeparator(*c)) c++;
+        WordList_set(words, index++, start, c - start);
+    }
+
+    return true;
+}
+
+bool readWordsFromFile(PuzzleInput* input, Arena* arena, WordList* words) {
+    size_t pos = input->pos;
+    bool found = false;
+
+    // The search stops at the end of the document in a batch input
+    while (pos < input->size && !found) {
+        size_t end = lineEnd(input, pos);
+        if (isDelimiter(input->data + pos, end - pos)) break;
+        found = isWordsMarker(input->data + pos, end - pos);
+        pos = nextLine(input, end);
+    }
+
+    // The words are on the line after the marker
+    const char* line = input->data + pos;
+    const char* lineStop = found ? input->data + lineEnd(input, pos) : line;
+    input->pos = found ? nextLine(input, lineStop - input->data) : pos;
+
+    return parseWords(line, lineStop, arena, words);
+}
+
+// Words for a dictionary: the list after the word list marker when the
+// input has one, as in a puzzle file, otherwise every word in the input
+bool readWordList(PuzzleInput* input, Arena* arena, WordList* words) {
+    for (size_t pos = input->pos; pos < input->size; ) {
+        size_t end = lineEnd(input, pos);
+        if (isWordsMarker(input->data + pos, end - pos)) {
+            return readWordsFromFile(input, arena, words);
         }
-        free(lines[i]);
+        pos = nextLine(input, end);
     }
-    free(lines);
 
+    bool parsed = parseWords(input->data + input->pos, input->data + input->size, arena, words);
+    input->pos = input->size;
+    return parsed;
+}
+
+Grid* readPuzzle(PuzzleInput* input, Arena* arena, WordList* words) {
+    if (isBinaryPuzzle(input)) {
+        return readBinaryPuzzle(input, arena, words);
+    }
+
+    Grid* grid = readPuzzleFromFile(input);
+    if (grid && !readWordsFromFile(input, arena, words)) {
+        Grid_destroy(grid);
+        return NULL;
+    }
     return grid;
 }
 
-void readWordsFromFile(char words[][MAX_WORD_LENGTH], int* numWords) {
-    char line[MAX_LINE_LENGTH];
-    *numWords = 0;
+bool PuzzleBatch_open(const char* inputFile, const char* manifestFile, PuzzleBatch* batch) {
+    memset(batch, 0, sizeof(PuzzleBatch));
+    batch->fromManifest = manifestFile != NULL;
+    return manifestFile ? PuzzleInput_open(manifestFile, &batch->manifest)
+                        : PuzzleInput_open(inputFile, &batch->input);
+}
 
-    while (fgets(line, MAX_LINE_LENGTH, stdin)) {
-        if (strstr(line, "Palavras:") != NULL) {
-            break;
+void PuzzleBatch_close(PuzzleBatch* batch) {
+    PuzzleInput_close(&batch->input);
+    PuzzleInput_close(&batch->manifest);
+    free(batch->name);
+    memset(batch, 0, sizeof(PuzzleBatch));
+}
+
+// Moves past blank and delimiter lines; false once the input is used up
+static bool skipToDocument(PuzzleInput* input) {
+    while (input->pos < input->size) {
+        size_t end = lineEnd(input, input->pos);
+        const char* line = input->data + input->pos;
+        if (scanRow(line, input->data + end, NULL) != 0 && !isDelimiter(line, end - input->pos)) {
+            return true;
         }
+        input->pos = nextLine(input, end);
     }
+    return false;
+}
 
-    if (fgets(line, MAX_LINE_LENGTH, stdin)) {
-        line[strcspn(line, "\n")] = 0;
-        char* token = strtok(line, " ,");
+// Copies the next path in the manifest into batch->name. Blank lines and
+// lines starting with '#' are skipped.
+static bool nextManifestPath(PuzzleBatch* batch) {
+    PuzzleInput* manifest = &batch->manifest;
+
+    while (manifest->pos < manifest->size) {
+        size_t end = lineEnd(manifest, manifest->pos);
+        const char* line = manifest->data + manifest->pos;
+        size_t length = end - manifest->pos;
+        manifest->pos = nextLine(manifest, end);
+
+        trimLine(&line, &length);
+        if (length == 0 || line[0] == '#') continue;
+
+        if (length + 1 > batch->nameCapacity) {
+            char* temp = (char*)realloc(batch->name, length + 1);
+            if (!temp) return false;
+            batch->name = temp;
+            batch->nameCapacity = length + 1;
+        }
+        memcpy(batch->name, line, length);
+        batch->name[length] = '\0';
+        return true;
+    }
+    return false;
+}
+
+// Reads the next puzzle, skipping (and reporting) ones that cannot be
+// read. The previous grid must be destroyed first: a binary grid points
+// into the input this call may close.
+Grid* PuzzleBatch_next(PuzzleBatch* batch, Arena* arena, WordList* words) {
+    for (;;) {
+        if (skipToDocument(&batch->input)) {
+            Grid* grid = readPuzzle(&batch->input, arena, words);
+            if (grid) {
+                batch->count++;
+                return grid;
+            }
+
+            fprintf(stderr, "Error: Failed to read puzzle %s; skipping the rest of it\n",
+                    batch->fromManifest ? batch->name : "from the batch input");
+            batch->input.pos = batch->input.size;
+            continue;
+        }
 
-        while (token != NULL && *numWords < MAX_WORDS) {
-            while (isspace(*token)) token++;
-            strcpy(words[*numWords], token);
-            (*numWords)++;
-            token = strtok(NULL, " ,");
+        if (!batch->fromManifest) return NULL;
+        PuzzleInput_close(&batch->input);
+        if (!nextManifestPath(batch)) return NULL;
+        if (!PuzzleInput_open(batch->name, &batch->input)) {
+            fprintf(stderr, "Error: Failed to open puzzle %s\n", batch->name);
         }
     }
 }
@@ -4,7 +4,42 @@
 #include "types.h"
 #include "grid.h"
 
-Grid* readPuzzleFromFile(void);
-void readWordsFromFile(char words[][MAX_WORD_LENGTH], int* numWords);
+// Puzzle text held in memory: mapped when it is a regular file, otherwise
+// read in once from the stream
+typedef struct {
+    const char* data;
+    size_t size;
+    size_t pos;         // Start of the next line to parse
+    void* mapping;      // mmap of the input file, or NULL
+    size_t mappedSize;
+    char* buffer;       // Heap copy of a stream input, or NULL
+} PuzzleInput;
+
+// Opens path, or stdin when path is NULL
+bool PuzzleInput_open(const char* path, PuzzleInput* input);
+void PuzzleInput_close(PuzzleInput* input);
+
+Grid* readPuzzleFromFile(PuzzleInput* input);
+bool readWordsFromFile(PuzzleInput* input, Arena* arena, WordList* words);
+bool readWordList(PuzzleInput* input, Arena* arena, WordList* words);
+
+// Grid and words from a text or binary (.wsb) puzzle. A binary grid points
+// into the input, so the input must stay open until the grid is destroyed.
+Grid* readPuzzle(PuzzleInput* input, Arena* arena, WordList* words);
+
+// Puzzles for batch mode: the documents of one input, separated by blank
+// or "---" lines, or the puzzle files listed one per line in a manifest
+typedef struct {
+    PuzzleInput input;      // Input holding the current puzzle
+    PuzzleInput manifest;   // Open when the puzzles come from a manifest
+    bool fromManifest;
+    char* name;             // Current manifest entry
+    size_t nameCapacity;
+    int count;              // Puzzles read so far
+} PuzzleBatch;
+
+bool PuzzleBatch_open(const char* inputFile, const char* manifestFile, PuzzleBatch* batch);
+Grid* PuzzleBatch_next(PuzzleBatch* batch, Arena* arena, WordList* words);
+void PuzzleBatch_close(PuzzleBatch* batch);
 
 #endif // FILE_IO_H
@@ -0,0 +1,176 @@
+#include "folded.h"
+#include "search.h"
+#include "simd_scan.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Letters scanned per row: the first two of the word and of its reverse
+enum { SCAN_FIRST, SCAN_LAST, SCAN_SECOND, SCAN_BEFORE_LAST };
+
+// Word m of mask moved so that bit k holds bit k + dy, the cell one
+// column along dy
+static inline uint64_t shiftedMaskWord(const uint64_t* mask, int m, int maskWords, int dy) {
+    if (dy > 0) return mask[m] >> 1 | (m + 1 < maskWords ? mask[m + 1] << 63 : 0);
+    if (dy < 0) return mask[m] << 1 | (m > 0 ? mask[m - 1] >> 63 : 0);
+    return mask[m];
+}
+
+static void setMaskRange(uint64_t* mask, int maskWords, int from, int to) {
+    memset(mask, 0, maskWords * sizeof(uint64_t));
+    for (int k = from; k < to; k++) {
+        mask[k >> 6] |= 1ULL << (k & 63);
+    }
+}
+
+// Masks of one origin row: bit k for column k - (len - 1)
+enum {
+    MASK_ROW = 0,                           // Letters of the origin row, then the row below
+    MASK_COLUMNS = 2 * SCAN_LETTERS,        // Start columns for column steps -1, 0, 1
+    MASK_COUNT = MASK_COLUMNS + 3
+};
+
+// Walks the 4 forward directions only, comparing each line against the
+// word and its reverse in the same pass. A reverse match read from origin
+// o along d is the word starting at o + (len - 1) * d in the opposite
+// direction, so origins reach len - 1 cells above and beside range to
+// cover every start in it. Each (start, direction) has exactly one origin,
+// so palindromes are not reported twice. Needs len >= 2 and a halo of at
+// least len - 1.
+static void searchWordFolded(const Grid* grid, const WordList* words, int w, RowRange range,
+                             ProcessResults* results) {
+    const char* folded = WordList_folded(words, w);
+    int len = WordList_length(words, w);
+    char reversed[len + 1];
+    for (int k = 0; k < len; k++) {
+        reversed[k] = folded[len - 1 - k];
+    }
+    reversed[len] = '\0';
+    const char letters[SCAN_LETTERS] = {
+        folded[0], reversed[0], folded[1], reversed[1]
+    };
+
+    int reach = len - 1;
+    int width = grid->cols + 2 * reach;
+    int maskWords = (width + 63) / 64;
+    uint64_t stackMasks[MASK_COUNT * 16];
+    uint64_t* block = maskWords <= 16 ? stackMasks
+                    : (uint64_t*)malloc((size_t)MASK_COUNT * maskWords * sizeof(uint64_t));
+
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    bool ok = block && hits;
+    if (!ok) {
+        if (block != stackMasks) free(block);
+        free(hits);
+        results->failed = true;
+        return;
+    }
+
+    uint64_t* masks[MASK_COUNT];
+    for (int i = 0; i < MASK_COUNT; i++) {
+        masks[i] = block + (size_t)i * maskWords;
+    }
+    for (int dy = -1; dy <= 1; dy++) {
+        setMaskRange(masks[MASK_COLUMNS + dy + 1], maskWords,
+                     reach - reach * dy, reach - reach * dy + grid->cols);
+    }
+    findLetterCells(grid, range.start - reach, -reach, width, letters, masks + MASK_ROW);
+
+    for (int i = range.start - reach, current = 0; i < range.end && ok; i++, current ^= 1) {
+        uint64_t* const* here = masks + MASK_ROW + current * SCAN_LETTERS;
+        uint64_t* const* below = masks + MASK_ROW + (current ^ 1) * SCAN_LETTERS;
+        findLetterCells(grid, i + 1, -reach, width, letters, below);
+
+        // Second letters one step along each forward direction: to the
+        // right in this row, or below-left, below or below-right in the next
+        const uint64_t* second[2] = {here[SCAN_SECOND], below[SCAN_SECOND]};
+        const uint64_t* beforeLast[2] = {here[SCAN_BEFORE_LAST], below[SCAN_BEFORE_LAST]};
+        uint64_t forwardRow = i >= range.start ? ~0ULL : 0;
+        uint64_t reverseRow[2] = {
+            forwardRow, i + reach >= range.start && i + reach < range.end ? ~0ULL : 0
+        };
+
+        for (int m = 0; m < maskWords && ok; m++) {
+            uint64_t first = here[SCAN_FIRST][m] & masks[MASK_COLUMNS + 1][m] & forwardRow;
+            uint64_t last = here[SCAN_LAST][m];
+            uint64_t origins[FORWARD_DIRECTIONS_COUNT][2];
+
+            // Origins holding the first two letters of a pattern along d
+            for (int d = 0; d < FORWARD_DIRECTIONS_COUNT; d++) {
+                DirectionVector vector = DIRECTION_VECTORS[FORWARD_DIRECTIONS[d][0]];
+                origins[d][0] = first & shiftedMaskWord(second[vector.dx], m, maskWords, vector.dy);
+                origins[d][1] = last & masks[MASK_COLUMNS + vector.dy + 1][m] & reverseRow[vector.dx] &
+                                shiftedMaskWord(beforeLast[vector.dx], m, maskWords, vector.dy);
+            }
+
+            for (int d = 0; d < FORWARD_DIRECTIONS_COUNT && ok; d++) {
+                DirectionVector vector = DIRECTION_VECTORS[FORWARD_DIRECTIONS[d][0]];
+                int step = Grid_stepOffset(grid, vector.dx, vector.dy);
+
+                for (uint64_t bits = origins[d][0] | origins[d][1]; bits && ok; bits &= bits - 1) {
+                    int bit = __builtin_ctzll(bits);
+                    int j = m * 64 + bit - reach;
+                    bool forward = (origins[d][0] >> bit) & 1;
+                    bool backward = (origins[d][1] >> bit) & 1;
+
+                    // One read of each cell serves both patterns
+                    const char* cell = Grid_cellPtr(grid, i, j) + step;
+                    for (int k = 2; k < len && (forward || backward); k++) {
+                        cell += step;
+                        forward = forward && *cell == folded[k];
+                        backward = backward && *cell == reversed[k];
+                    }
+
+                    if (forward) {
+                        ok = pushSearchHit(&hits, &numHits, &hitCapacity,
+                                           (SearchHit){w, i, j, FORWARD_DIRECTIONS[d][0]});
+                    }
+                    if (backward && ok) {
+                        ok = pushSearchHit(&hits, &numHits, &hitCapacity,
+                                           (SearchHit){w, i + reach * vector.dx, j + reach * vector.dy,
+                                                       FORWARD_DIRECTIONS[d][1]});
+                    }
+                }
+            }
+        }
+    }
+
+    if (ok) {
+        // Origins are not visited in start order; sort back to row, column, direction
+        appendSortedHits(grid, words, hits, numHits, results);
+    } else {
+        results->failed = true;
+    }
+
+    if (block != stackMasks) free(block);
+    free(hits);
+}
+
+// The brute search with direction folding: each word is walked along the
+// 4 forward directions only, against itself and its reverse
+void searchWordsFolded(Grid* grid, const WordList* words, RowRange range,
+                       ProcessResults* results) {
+    if (searchWordsFallback(grid, words, range, results,
+                            Grid_ensureSearchLayout(grid, words->longest - 1))) {
+        return;
+    }
+
+    for (int w = 0; w < words->count; w++) {
+        int foundBefore = results->validResults;
+
+        // Single letters have no direction to fold
+        if (WordList_length(words, w) > 1) {
+            searchWordFolded(grid, words, w, range, results);
+        } else {
+            searchWordParallel(grid, words, w, range, results);
+        }
+        results->totalProcessed++;
+
+        debugPrint("Process found %d instances of word '%s'\n",
+                  results->validResults - foundBefore, WordList_word(words, w));
+    }
+}
@@ -0,0 +1,10 @@
+#ifndef FOLDED_H
+#define FOLDED_H
+
+#include "types.h"
+#include "grid.h"
+
+void searchWordsFolded(Grid* grid, const WordList* words, RowRange range,
+                       ProcessResults* results);
+
+#endif // FOLDED_H
@@ -0,0 +1,118 @@
+#include "gram_filter.h"
+#include "word_list.h"
+#include "constants.h"
+#include "debug.h"
+#include <stdlib.h>
+#include <string.h>
+
+static inline uint32_t bigramBit(unsigned char a, unsigned char b) {
+    return GRAM_FILTER_BIGRAMS + ((uint32_t)a << 8 | b);
+}
+
+static inline uint32_t trigramBit(unsigned char a, unsigned char b, unsigned char c) {
+    uint32_t key = ((uint32_t)a << 16) | ((uint32_t)b << 8) | c;
+    return GRAM_FILTER_TRIGRAMS + ((key * 2654435761u) >> (32 - 20));
+}
+
+static inline void setBit(GramFilter* filter, uint32_t bit) {
+    filter->bits[bit >> 6] |= 1ULL << (bit & 63);
+}
+
+static inline bool hasBit(const GramFilter* filter, uint32_t bit) {
+    return (filter->bits[bit >> 6] >> (bit & 63)) & 1;
+}
+
+GramFilter* GramFilter_create(int order) {
+    GramFilter* filter = (GramFilter*)calloc(1, sizeof(GramFilter));
+    if (filter) filter->order = order < 1 ? 1 : order > 3 ? 3 : order;
+    return filter;
+}
+
+void GramFilter_destroy(GramFilter* filter) {
+    free(filter);
+}
+
+// Records the grams starting at the cells of rows. The padded layout
+// must be at least order - 1 cells wide; the cells past the edge then
+// hold the wrapped letters.
+void GramFilter_addRows(GramFilter* filter, const Grid* grid, RowRange rows) {
+    int steps[FORWARD_DIRECTIONS_COUNT];
+    for (int d = 0; d < FORWARD_DIRECTIONS_COUNT; d++) {
+        DirectionVector vector = DIRECTION_VECTORS[FORWARD_DIRECTIONS[d][0]];
+        steps[d] = Grid_stepOffset(grid, vector.dx, vector.dy);
+    }
+
+    for (int i = rows.start; i < rows.end; i++) {
+        const char* rowCells = Grid_cellPtr(grid, i, 0);
+        for (int j = 0; j < grid->cols; j++) {
+            const char* cell = rowCells + j;
+            unsigned char a = (unsigned char)cell[0];
+            setBit(filter, GRAM_FILTER_LETTERS + a);
+            if (filter->order < 2) continue;
+
+            // A gram read backwards is the gram of the opposite direction
+            for (int d = 0; d < FORWARD_DIRECTIONS_COUNT; d++) {
+                unsigned char b = (unsigned char)cell[steps[d]];
+                setBit(filter, bigramBit(a, b));
+                setBit(filter, bigramBit(b, a));
+                if (filter->order < 3) continue;
+
+                unsigned char c = (unsigned char)cell[2 * steps[d]];
+                setBit(filter, trigramBit(a, b, c));
+                setBit(filter, trigramBit(c, b, a));
+            }
+        }
+    }
+}
+
+bool GramFilter_admits(const GramFilter* filter, const char* folded, int len) {
+    const unsigned char* word = (const unsigned char*)folded;
+    for (int i = 0; i < len; i++) {
+        if (!hasBit(filter, GRAM_FILTER_LETTERS + word[i])) return false;
+    }
+    for (int i = 0; filter->order >= 2 && i + 1 < len; i++) {
+        if (!hasBit(filter, bigramBit(word[i], word[i + 1]))) return false;
+    }
+    for (int i = 0; filter->order >= 3 && i + 2 < len; i++) {
+        if (!hasBit(filter, trigramBit(word[i], word[i + 1], word[i + 2]))) return false;
+    }
+    return true;
+}
+
+// Copies the words the filter admits into kept, in order, with the index
+// of each in words in original. Returns how many were ruled out, or -1
+// when arena is out of memory.
+int GramFilter_apply(const GramFilter* filter, const WordList* words, Arena* arena,
+                     WordList* kept, int** original) {
+    int* indices = (int*)Arena_alloc(arena, (words->count > 0 ? words->count : 1) * sizeof(int));
+    if (!indices) return -1;
+
+    int count = 0;
+    size_t letters = 0;
+    for (int w = 0; w < words->count; w++) {
+        if (GramFilter_admits(filter, WordList_folded(words, w), WordList_length(words, w))) {
+            indices[count++] = w;
+            letters += WordList_length(words, w);
+        }
+    }
+
+    if (!WordList_init(kept, arena, count, letters)) return -1;
+    for (int k = 0; k < count; k++) {
+        WordList_set(kept, k, WordList_word(words, indices[k]), WordList_length(words, indices[k]));
+    }
+
+    debugPrint("DEBUG Prefilter: %d of %d words kept\n", count, words->count);
+    *original = indices;
+    return words->count - count;
+}
+
+// Points the results from first on, found among the kept words, back at
+// the list words they were taken from
+void remapWordIndices(ProcessResults* results, int first, const int* original,
+                      const WordList* words) {
+    for (int i = first; i < results->validResults; i++) {
+        WordPosition* pos = &results->positions[i];
+        pos->wordIndex = original[pos->wordIndex];
+        pos->word = WordList_word(words, pos->wordIndex);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef GRAM_FILTER_H
+#define GRAM_FILTER_H
+
+#include "types.h"
+#include "grid.h"
+#include <stdint.h>
+
+// Bit ranges of the filter: every byte, every byte pair, and trigrams
+// hashed into GRAM_FILTER_TRIGRAM_BITS bits
+#define GRAM_FILTER_TRIGRAM_BITS (1 << 20)
+#define GRAM_FILTER_LETTERS 0
+#define GRAM_FILTER_BIGRAMS 256
+#define GRAM_FILTER_TRIGRAMS (GRAM_FILTER_BIGRAMS + 256 * 256)
+#define GRAM_FILTER_WORDS ((GRAM_FILTER_TRIGRAMS + GRAM_FILTER_TRIGRAM_BITS) / 64)
+
+// Which letters, letter pairs and (hashed) letter triples occur in a grid
+// along any of the 8 directions, with wrap. A word with one that does not
+// occur cannot be in the grid; trigram collisions only let a few more
+// words through. Filters of parts of a grid combine with a bitwise OR.
+typedef struct {
+    int order;                          // Longest gram recorded, 1 to 3
+    uint64_t bits[GRAM_FILTER_WORDS];
+} GramFilter;
+
+GramFilter* GramFilter_create(int order);
+void GramFilter_destroy(GramFilter* filter);
+void GramFilter_addRows(GramFilter* filter, const Grid* grid, RowRange rows);
+bool GramFilter_admits(const GramFilter* filter, const char* folded, int len);
+int GramFilter_apply(const GramFilter* filter, const WordList* words, Arena* arena,
+                     WordList* kept, int** original);
+void remapWordIndices(ProcessResults* results, int first, const int* original,
+                      const WordList* words);
+
+#endif // GRAM_FILTER_H
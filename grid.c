@@ -6,60 +6,123 @@
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
+#include <ctype.h>
 
-Grid* Grid_create(int rows, int cols) {
-    Grid* grid = (Grid*)malloc(sizeof(Grid));
+// Allocates a grid whose letters block is either letters, left owned by
+// the caller, or a fresh block when letters is NULL
+static Grid* allocateGrid(int rows, int cols, char* letters) {
+    Grid* grid = (Grid*)calloc(1, sizeof(Grid));
     if (!grid) return NULL;
 
     grid->rows = rows;
     grid->cols = cols;
+    grid->sharedLetters = letters != NULL;
 
-    // Allocate arrays
-    grid->letters = (char**)malloc(rows * sizeof(char*));
-    grid->highlighted = (char**)malloc(rows * sizeof(char*));
+    // Row pointer arrays over a single block each
+    grid->letters = (char**)calloc(rows > 0 ? rows : 1, sizeof(char*));
+    grid->highlighted = (char**)calloc(rows > 0 ? rows : 1, sizeof(char*));
 
     if (!grid->letters || !grid->highlighted) {
         Grid_destroy(grid);
         return NULL;
     }
 
-    // Initialize arrays
-    for (int i = 0; i < rows; i++) {
-        grid->letters[i] = (char*)malloc(cols * sizeof(char));
-        grid->highlighted[i] = (char*)malloc(cols * sizeof(char));
+    size_t cellCount = (size_t)rows * cols;
+    grid->letters[0] = letters ? letters : (char*)malloc(cellCount > 0 ? cellCount : 1);
+    grid->highlighted[0] = (char*)malloc(cellCount > 0 ? cellCount : 1);
 
-        if (!grid->letters[i] || !grid->highlighted[i]) {
-            Grid_destroy(grid);
-            return NULL;
-        }
+    if (!grid->letters[0] || !grid->highlighted[0]) {
+        Grid_destroy(grid);
+        return NULL;
+    }
 
-        // Initialize highlighted array with spaces
-        for (int j = 0; j < cols; j++) {
-            grid->highlighted[i][j] = ' ';
-        }
-        debugPrint("DEBUG Create: Row %d highlighted array initialized\n", i);
+    // Initialize letters and highlighted array with spaces
+    if (!letters) memset(grid->letters[0], ' ', cellCount);
+    memset(grid->highlighted[0], ' ', cellCount);
+
+    for (int i = 1; i < rows; i++) {
+        grid->letters[i] = grid->letters[i - 1] + cols;
+        grid->highlighted[i] = grid->highlighted[i - 1] + cols;
     }
+    debugPrint("DEBUG Create: %d x %d grid %s\n", rows, cols, letters ? "viewed" : "allocated");
 
     return grid;
 }
 
+Grid* Grid_create(int rows, int cols) {
+    return allocateGrid(rows, cols, NULL);
+}
+
+// Grid over a row-major letters block owned elsewhere, such as a mapped
+// puzzle file. The block must outlive the grid and is never written.
+Grid* Grid_createView(int rows, int cols, const char* letters) {
+    return allocateGrid(rows, cols, (char*)letters);
+}
+
+// Gives a view its own copy of the letters, so the grid outlives the
+// block it was created over
+bool Grid_ownLetters(Grid* grid) {
+    if (!grid->sharedLetters) return true;
+
+    size_t cellCount = (size_t)grid->rows * grid->cols;
+    char* letters = (char*)malloc(cellCount > 0 ? cellCount : 1);
+    if (!letters) return false;
+    memcpy(letters, grid->letters[0], cellCount);
+
+    grid->letters[0] = letters;
+    for (int i = 1; i < grid->rows; i++) {
+        grid->letters[i] = grid->letters[i - 1] + grid->cols;
+    }
+    grid->sharedLetters = false;
+    return true;
+}
+
+bool Grid_buildSearchLayout(Grid* grid, int halo) {
+    if (!grid || grid->rows <= 0 || grid->cols <= 0) return false;
+    if (halo < 0) halo = 0;
+
+    int stride = grid->cols + 2 * halo;
+    int paddedRows = grid->rows + 2 * halo;
+    char* cells = (char*)malloc((size_t)stride * paddedRows);
+    if (!cells) return false;
+
+    // Fill the halo with the wrapped neighbours so walks never need a modulo
+    for (int r = 0; r < paddedRows; r++) {
+        const char* source = grid->letters[((r - halo) % grid->rows + grid->rows) % grid->rows];
+        char* target = cells + (size_t)r * stride;
+        for (int c = 0; c < stride; c++) {
+            target[c] = (char)tolower((unsigned char)source[((c - halo) % grid->cols + grid->cols) % grid->cols]);
+        }
+    }
+
+    free(grid->cells);
+    grid->cells = cells;
+    grid->stride = stride;
+    grid->halo = halo;
+
+    debugPrint("DEBUG Layout: halo %d, padded grid %d x %d\n", halo, paddedRows, stride);
+    return true;
+}
+
+bool Grid_ensureSearchLayout(Grid* grid, int halo) {
+    if (grid->cells && grid->halo >= halo) return true;
+    return Grid_buildSearchLayout(grid, halo);
+}
+
 void Grid_destroy(Grid* grid) {
     if (!grid) return;
 
     if (grid->letters) {
-        for (int i = 0; i < grid->rows; i++) {
-            free(grid->letters[i]);
-        }
+        if (!grid->sharedLetters) free(grid->letters[0]);
         free(grid->letters);
     }
 
     if (grid->highlighted) {
-        for (int i = 0; i < grid->rows; i++) {
-            free(grid->highlighted[i]);
-        }
+        free(grid->highlighted[0]);
         free(grid->highlighted);
     }
 
+    free(grid->cells);
     free(grid);
 }
 
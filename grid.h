@@ -3,13 +3,29 @@
 
 #include "types.h"
 #include <stdbool.h>
+#include <stddef.h>
 
 // Grid management functions
 Grid* Grid_create(int rows, int cols);
+Grid* Grid_createView(int rows, int cols, const char* letters);
 void Grid_destroy(Grid* grid);
+bool Grid_ownLetters(Grid* grid);
+bool Grid_buildSearchLayout(Grid* grid, int halo);
+bool Grid_ensureSearchLayout(Grid* grid, int halo);
 bool Grid_isValidPosition(const Grid* grid, int row, int col);
 void Grid_highlightWord(Grid* grid, const WordPosition pos);
 void Grid_print(const Grid* grid);
 void Grid_exportToFile(const Grid* grid, const char* filename, bool useHTML);
 
+// Address of (row, col) in the padded search layout. Valid for
+// -halo <= row < rows + halo and -halo <= col < cols + halo.
+static inline const char* Grid_cellPtr(const Grid* grid, int row, int col) {
+    return grid->cells + (size_t)(row + grid->halo) * grid->stride + (col + grid->halo);
+}
+
+// Pointer offset of one step in the padded search layout
+static inline int Grid_stepOffset(const Grid* grid, int dx, int dy) {
+    return dx * grid->stride + dy;
+}
+
 #endif // GRID_H
@@ -0,0 +1,375 @@
+#include "grid_index.h"
+#include "search.h"
+#include "word_list.h"
+#include "constants.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Bucket table bounds; the table aims at a few entries per bucket
+#define GRID_INDEX_MIN_BITS 8
+#define GRID_INDEX_MAX_BITS 20
+
+// Multiplicative hash of GRID_INDEX_K case-folded letters read step bytes
+// apart, to bucketBits bits
+static uint32_t gramBucket(const char* letters, int step, int bucketBits) {
+    uint32_t key = 0;
+    for (int i = 0; i < GRID_INDEX_K; i++, letters += step) {
+        key = key * 257 + (unsigned char)*letters;
+    }
+    return (key * 2654435761u) >> (32 - bucketBits);
+}
+
+static int chooseBucketBits(uint64_t entryCount) {
+    int bits = GRID_INDEX_MIN_BITS;
+    while (bits < GRID_INDEX_MAX_BITS && ((uint64_t)1 << bits) * 4 < entryCount) {
+        bits++;
+    }
+    return bits;
+}
+
+// FNV-1a over the case-folded letters, so a saved index is only used for
+// the grid it was built from
+static uint64_t gridFingerprint(const Grid* grid) {
+    uint64_t hash = 14695981039346656037ull;
+    for (int i = 0; i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            hash ^= (unsigned char)tolower((unsigned char)grid->letters[i][j]);
+            hash *= 1099511628211ull;
+        }
+    }
+    return hash;
+}
+
+// Files every start position and direction of the given rows under the gram
+// read from there, by a counting sort over the buckets. Start positions are
+// visited in row, column and direction order, which each bucket keeps.
+GridIndex* GridIndex_build(Grid* grid, RowRange rows) {
+    uint64_t entryCount = (uint64_t)(rows.end - rows.start) * grid->cols * DIRECTIONS_COUNT;
+    if (entryCount == 0 || (uint64_t)rows.end * grid->cols * DIRECTIONS_COUNT > UINT32_MAX ||
+        !Grid_ensureSearchLayout(grid, GRID_INDEX_K - 1)) {
+        return NULL;
+    }
+
+    int bucketBits = chooseBucketBits(entryCount);
+    size_t bucketCount = (size_t)1 << bucketBits;
+    GridIndex* index = (GridIndex*)calloc(1, sizeof(GridIndex));
+    uint32_t* buckets = (uint32_t*)calloc(bucketCount + 1, sizeof(uint32_t));
+    uint32_t* fill = (uint32_t*)malloc(bucketCount * sizeof(uint32_t));
+    uint32_t* entries = (uint32_t*)malloc(entryCount * sizeof(uint32_t));
+    uint32_t* keys = (uint32_t*)malloc(entryCount * sizeof(uint32_t));
+    if (!index || !buckets || !fill || !entries || !keys) {
+        free(index);
+        free(buckets);
+        free(fill);
+        free(entries);
+        free(keys);
+        return NULL;
+    }
+
+    int steps[DIRECTIONS_COUNT];
+    for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+        steps[dir] = Grid_stepOffset(grid, DIRECTION_VECTORS[dir].dx, DIRECTION_VECTORS[dir].dy);
+    }
+
+    uint32_t entry = 0;
+    for (int i = rows.start; i < rows.end; i++) {
+        const char* rowCells = Grid_cellPtr(grid, i, 0);
+        for (int j = 0; j < grid->cols; j++) {
+            for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++, entry++) {
+                keys[entry] = gramBucket(rowCells + j, steps[dir], bucketBits);
+                buckets[keys[entry] + 1]++;
+            }
+        }
+    }
+    for (size_t b = 0; b < bucketCount; b++) {
+        buckets[b + 1] += buckets[b];
+        fill[b] = buckets[b];
+    }
+    // Entries number start positions from the top of the grid, not of rows
+    uint32_t firstEntry = (uint32_t)rows.start * grid->cols * DIRECTIONS_COUNT;
+    for (uint32_t e = 0; e < entryCount; e++) {
+        entries[fill[keys[e]]++] = firstEntry + e;
+    }
+    free(fill);
+    free(keys);
+
+    index->buckets = buckets;
+    index->entries = entries;
+    index->bucketBits = bucketBits;
+    index->rows = grid->rows;
+    index->cols = grid->cols;
+    index->filed = rows;
+    // Only an index of every row is saved; a row slab holds no other letters
+    bool whole = rows.start == 0 && rows.end == grid->rows;
+    index->fingerprint = whole ? gridFingerprint(grid) : 0;
+
+    debugPrint("DEBUG Index: %llu entries in %zu buckets\n",
+               (unsigned long long)entryCount, bucketCount);
+    return index;
+}
+
+static bool sectionFits(uint64_t offset, uint64_t length, size_t size) {
+    return offset % GRID_INDEX_ALIGNMENT == 0 && offset <= size && length <= size - offset;
+}
+
+// Every bucket range and entry is checked, so a corrupt file cannot send
+// the search outside the grid
+static bool validateIndex(const GridIndexHeader* header, const char* base, size_t size) {
+    uint64_t entryCount = (uint64_t)header->rows * header->cols * DIRECTIONS_COUNT;
+    if (header->bucketBits < GRID_INDEX_MIN_BITS || header->bucketBits > GRID_INDEX_MAX_BITS ||
+        header->entryCount != entryCount ||
+        !sectionFits(header->bucketsOffset,
+                     (((uint64_t)1 << header->bucketBits) + 1) * sizeof(uint32_t), size) ||
+        !sectionFits(header->entriesOffset, entryCount * sizeof(uint32_t), size)) {
+        return false;
+    }
+
+    const uint32_t* buckets = (const uint32_t*)(base + header->bucketsOffset);
+    const uint32_t* entries = (const uint32_t*)(base + header->entriesOffset);
+    size_t bucketCount = (size_t)1 << header->bucketBits;
+    if (buckets[0] != 0 || buckets[bucketCount] != entryCount) return false;
+    for (size_t b = 0; b < bucketCount; b++) {
+        if (buckets[b] > buckets[b + 1]) return false;
+    }
+    for (uint64_t e = 0; e < entryCount; e++) {
+        if (entries[e] >= entryCount) return false;
+    }
+    return true;
+}
+
+// Maps the index saved at path if it was built from this grid. NULL when
+// the file is missing, stale or unusable.
+GridIndex* GridIndex_load(const char* path, const Grid* grid) {
+    int fd = open(path, O_RDONLY);
+    struct stat info;
+    if (fd < 0) {
+        if (errno != ENOENT) fprintf(stderr, "Warning: Failed to open grid index %s\n", path);
+        return NULL;
+    }
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(GridIndexHeader)) {
+        fprintf(stderr, "Warning: Grid index %s is truncated; rebuilding\n", path);
+        close(fd);
+        return NULL;
+    }
+
+    size_t size = info.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Warning: Failed to map grid index %s\n", path);
+        return NULL;
+    }
+
+    const char* base = (const char*)mapping;
+    const GridIndexHeader* header = (const GridIndexHeader*)base;
+    if (memcmp(header->magic, GRID_INDEX_MAGIC, 4) != 0 ||
+        header->version != GRID_INDEX_VERSION || header->k != GRID_INDEX_K) {
+        fprintf(stderr, "Warning: %s is not a version %d grid index; rebuilding\n",
+                path, GRID_INDEX_VERSION);
+        munmap(mapping, size);
+        return NULL;
+    }
+    if (header->rows != grid->rows || header->cols != grid->cols ||
+        header->fingerprint != gridFingerprint(grid)) {
+        debugPrint("DEBUG Index: %s was built for another grid\n", path);
+        munmap(mapping, size);
+        return NULL;
+    }
+    if (!validateIndex(header, base, size)) {
+        fprintf(stderr, "Warning: Grid index %s is corrupt; rebuilding\n", path);
+        munmap(mapping, size);
+        return NULL;
+    }
+
+    GridIndex* index = (GridIndex*)calloc(1, sizeof(GridIndex));
+    if (!index) {
+        munmap(mapping, size);
+        return NULL;
+    }
+    index->buckets = (const uint32_t*)(base + header->bucketsOffset);
+    index->entries = (const uint32_t*)(base + header->entriesOffset);
+    index->bucketBits = header->bucketBits;
+    index->rows = header->rows;
+    index->cols = header->cols;
+    index->filed = (RowRange){0, header->rows};
+    index->fingerprint = header->fingerprint;
+    index->mapping = mapping;
+    index->mappedSize = size;
+    return index;
+}
+
+// Pads the file up to offset, then writes bytes of data there
+static bool writeSection(FILE* file, uint64_t* position, uint64_t offset,
+                         const void* data, size_t bytes) {
+    static const char zeros[GRID_INDEX_ALIGNMENT] = {0};
+    if (fwrite(zeros, 1, offset - *position, file) != offset - *position ||
+        fwrite(data, 1, bytes, file) != bytes) {
+        return false;
+    }
+    *position = offset + bytes;
+    return true;
+}
+
+// Writes the index to a temporary file renamed over path, so a process
+// mapping the old index keeps reading a complete file. Only an index of
+// every row can be saved.
+bool GridIndex_save(const GridIndex* index, const char* path) {
+    if (index->filed.start != 0 || index->filed.end != index->rows) return false;
+
+    GridIndexHeader header;
+    memset(&header, 0, sizeof(GridIndexHeader));
+    memcpy(header.magic, GRID_INDEX_MAGIC, 4);
+    header.version = GRID_INDEX_VERSION;
+    header.k = GRID_INDEX_K;
+    header.bucketBits = index->bucketBits;
+    header.rows = index->rows;
+    header.cols = index->cols;
+    header.fingerprint = index->fingerprint;
+    header.entryCount = (uint64_t)index->rows * index->cols * DIRECTIONS_COUNT;
+
+    uint64_t bucketBytes = (((uint64_t)1 << index->bucketBits) + 1) * sizeof(uint32_t);
+    uint64_t alignment = GRID_INDEX_ALIGNMENT;
+    header.bucketsOffset = (sizeof(GridIndexHeader) + alignment - 1) / alignment * alignment;
+    header.entriesOffset = (header.bucketsOffset + bucketBytes + alignment - 1) / alignment * alignment;
+
+    size_t pathLength = strlen(path);
+    char temporary[pathLength + 5];
+    memcpy(temporary, path, pathLength);
+    memcpy(temporary + pathLength, ".tmp", 5);
+
+    FILE* file = fopen(temporary, "wb");
+    if (!file) return false;
+
+    uint64_t position = 0;
+    bool written =
+        writeSection(file, &position, 0, &header, sizeof(GridIndexHeader)) &&
+        writeSection(file, &position, header.bucketsOffset, index->buckets, bucketBytes) &&
+        writeSection(file, &position, header.entriesOffset, index->entries,
+                     header.entryCount * sizeof(uint32_t));
+
+    if (fclose(file) != 0 || !written || rename(temporary, path) != 0) {
+        unlink(temporary);
+        return false;
+    }
+    return true;
+}
+
+// The index saved at path when it matches grid, otherwise a new one,
+// written to path when save is set. path may be NULL.
+GridIndex* GridIndex_open(Grid* grid, const char* path, bool save) {
+    GridIndex* index = path ? GridIndex_load(path, grid) : NULL;
+    if (index) return index;
+
+    index = GridIndex_build(grid, (RowRange){0, grid->rows});
+    if (index && path && save && !GridIndex_save(index, path)) {
+        fprintf(stderr, "Warning: Failed to save grid index %s\n", path);
+    }
+    return index;
+}
+
+void GridIndex_destroy(GridIndex* index) {
+    if (!index) return;
+
+    if (index->mapping) {
+        munmap(index->mapping, index->mappedSize);
+    } else {
+        free((void*)index->buckets);
+        free((void*)index->entries);
+    }
+    free(index);
+}
+
+// The index fits grid and files every row of range
+bool GridIndex_matches(const GridIndex* index, const Grid* grid, RowRange range) {
+    return index->rows == grid->rows && index->cols == grid->cols &&
+           index->filed.start <= range.start && range.end <= index->filed.end;
+}
+
+// Start positions the indexed search verifies for words: the bucket of
+// each word's leading gram, or every position for the shorter words
+long GridIndex_candidates(const GridIndex* index, const WordList* words) {
+    long positions = (long)(index->filed.end - index->filed.start) * index->cols * DIRECTIONS_COUNT;
+    long candidates = 0;
+
+    for (int w = 0; w < words->count; w++) {
+        int len = WordList_length(words, w);
+        if (len >= GRID_INDEX_K) {
+            uint32_t b = gramBucket(WordList_folded(words, w), 1, index->bucketBits);
+            candidates += index->buckets[b + 1] - index->buckets[b];
+        } else if (len > 0) {
+            candidates += positions;
+        }
+    }
+    return candidates;
+}
+
+// First entry of [low, high) at or after target; entries are ascending
+static uint32_t lowerBound(const uint32_t* entries, uint32_t low, uint32_t high,
+                           uint32_t target) {
+    while (low < high) {
+        uint32_t middle = low + (high - low) / 2;
+        if (entries[middle] < target) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Verifies only the start positions filed under each word's leading gram,
+// in the same order searchWords reports them. Words shorter than the gram,
+// and grids without a matching index, are scanned as usual.
+void searchWordsIndexed(Grid* grid, const WordList* words, RowRange range,
+                        ProcessResults* results) {
+    const GridIndex* index = grid->index;
+    if (!index || !GridIndex_matches(index, grid, range) ||
+        !Grid_ensureSearchLayout(grid, words->longest - 1)) {
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    int steps[DIRECTIONS_COUNT];
+    for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+        steps[dir] = Grid_stepOffset(grid, DIRECTION_VECTORS[dir].dx, DIRECTION_VECTORS[dir].dy);
+    }
+
+    uint32_t rowEntries = (uint32_t)grid->cols * DIRECTIONS_COUNT;
+    uint32_t first = range.start * rowEntries;
+    uint32_t last = range.end * rowEntries;
+
+    for (int w = 0; w < words->count; w++) {
+        const char* folded = WordList_folded(words, w);
+        int len = WordList_length(words, w);
+        results->totalProcessed++;
+        if (len < GRID_INDEX_K) {
+            searchWordParallel(grid, words, w, range, results);
+            continue;
+        }
+
+        uint32_t b = gramBucket(folded, 1, index->bucketBits);
+        uint32_t end = index->buckets[b + 1];
+        for (uint32_t e = lowerBound(index->entries, index->buckets[b], end, first);
+             e < end && index->entries[e] < last; e++) {
+            uint32_t cell = index->entries[e] / DIRECTIONS_COUNT;
+            Direction dir = (Direction)(index->entries[e] % DIRECTIONS_COUNT);
+            int row = cell / grid->cols;
+            int col = cell % grid->cols;
+
+            if (matchesFoldedWord(Grid_cellPtr(grid, row, col), steps[dir], folded, len)) {
+                WordPosition pos;
+                setWordPosition(grid, WordList_word(words, w), len, row, col, dir, &pos);
+                pos.wordIndex = w;
+                ProcessResults_add(results, &pos);
+            }
+        }
+    }
+}
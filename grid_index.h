@@ -0,0 +1,59 @@
+#ifndef GRID_INDEX_H
+#define GRID_INDEX_H
+
+#include "types.h"
+#include "grid.h"
+#include <stdint.h>
+
+// Letters of the gram each start position is filed under. Shorter words
+// are searched without the index.
+#define GRID_INDEX_K 3
+
+#define GRID_INDEX_MAGIC "WSI1"
+#define GRID_INDEX_VERSION 1
+
+// Sections start on this boundary so the arrays can be used in place
+#define GRID_INDEX_ALIGNMENT 64
+
+// Fixed header at the start of a .wsi file, in the writer's byte order
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t k;
+    uint32_t bucketBits;
+    int32_t rows;
+    int32_t cols;
+    uint64_t fingerprint;       // Hash of the case-folded grid the index was built from
+    uint64_t entryCount;        // rows x cols x 8
+    uint64_t bucketsOffset;     // bucketCount + 1 uint32 starts into entries
+    uint64_t entriesOffset;     // uint32 (row * cols + col) * 8 + direction
+} GridIndexHeader;
+
+// Every start position and direction of a grid, filed by a hash of the
+// GRID_INDEX_K letters read from there. Entries of a bucket are in row,
+// column and direction order. The arrays are either built on the heap or
+// point into a mapped .wsi file. A process that searches only some rows
+// files only those; saved and loaded indexes file every row.
+typedef struct GridIndex {
+    const uint32_t* buckets;
+    const uint32_t* entries;
+    int bucketBits;
+    int rows;
+    int cols;
+    RowRange filed;             // Rows whose start positions are filed
+    uint64_t fingerprint;
+    void* mapping;              // Mapped file, or NULL when built here
+    size_t mappedSize;
+} GridIndex;
+
+GridIndex* GridIndex_build(Grid* grid, RowRange rows);
+GridIndex* GridIndex_load(const char* path, const Grid* grid);
+bool GridIndex_save(const GridIndex* index, const char* path);
+GridIndex* GridIndex_open(Grid* grid, const char* path, bool save);
+void GridIndex_destroy(GridIndex* index);
+bool GridIndex_matches(const GridIndex* index, const Grid* grid, RowRange range);
+long GridIndex_candidates(const GridIndex* index, const WordList* words);
+void searchWordsIndexed(Grid* grid, const WordList* words, RowRange range,
+                        ProcessResults* results);
+
+#endif // GRID_INDEX_H
@@ -0,0 +1,183 @@
+#define _GNU_SOURCE
+#include "lines.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Padded cell of position p on line l. Rows run along the range with margin
+// cells on each side. The other families run down the range with margin rows
+// above and below: columns start at every column, while diagonals start far
+// enough outside the padded band that together they cross every cell of it.
+static void lineCell(const GridLines* lines, int family, int line, int p,
+                     int* row, int* col) {
+    DirectionVector vector = DIRECTION_VECTORS[lines->families[family].forward];
+    int length = lines->families[family].lineLength;
+
+    if (family == 0) {
+        *row = lines->range.start + line;
+        *col = -lines->margin + p;
+    } else {
+        int startCol = vector.dy == 0 ? line
+                     : -lines->margin + line - (vector.dy > 0 ? length - 1 : 0);
+        *row = lines->range.start - lines->margin + p * vector.dx;
+        *col = startCol + p * vector.dy;
+    }
+}
+
+// Reads the padded halo directly, so margin must not exceed grid->halo. A
+// tile or row slab holds no more than its halo, and wrapping inside it would
+// read the wrong neighbours.
+GridLines* GridLines_create(const Grid* grid, RowRange range, int margin) {
+    GridLines* lines = (GridLines*)calloc(1, sizeof(GridLines));
+    if (!lines) return NULL;
+
+    lines->range = range;
+    lines->margin = margin;
+
+    int bandRows = range.end - range.start + 2 * margin;
+    int bandCols = grid->cols + 2 * margin;
+    for (int f = 0; f < LINE_FAMILIES_COUNT; f++) {
+        LineFamily* family = &lines->families[f];
+        DirectionVector vector = DIRECTION_VECTORS[FORWARD_DIRECTIONS[f][0]];
+        // The reverse is searched with the reversed word on the same lines
+        family->forward = FORWARD_DIRECTIONS[f][0];
+        family->reverse = FORWARD_DIRECTIONS[f][1];
+        if (f == 0) {
+            family->lineCount = range.end - range.start;
+            family->lineLength = bandCols;
+        } else {
+            family->lineCount = vector.dy == 0 ? grid->cols : bandCols + bandRows - 1;
+            family->lineLength = bandRows;
+        }
+        family->data = (char*)malloc((size_t)family->lineCount * (family->lineLength + 1) + 1);
+
+        if (!family->data) {
+            GridLines_destroy(lines);
+            return NULL;
+        }
+
+        // Copy every line once, case-folded. Diagonal cells outside the
+        // padded band become separators, so no match runs through them.
+        char* out = family->data;
+        for (int l = 0; l < family->lineCount; l++) {
+            for (int p = 0; p < family->lineLength; p++) {
+                int row, col;
+                lineCell(lines, f, l, p, &row, &col);
+                bool inside = col >= -margin && col < grid->cols + margin;
+                *out++ = inside ? *Grid_cellPtr(grid, row, col) : '\0';
+            }
+            *out++ = '\0';
+        }
+        *out = '\0';
+    }
+
+    debugPrint("DEBUG Lines: rows %d to %d, margin %d\n", range.start, range.end - 1, margin);
+    return lines;
+}
+
+void GridLines_destroy(GridLines* lines) {
+    if (!lines) return;
+
+    for (int f = 0; f < LINE_FAMILIES_COUNT; f++) {
+        free(lines->families[f].data);
+    }
+    free(lines);
+}
+
+// Records the match at position p of line l if its start cell belongs to
+// the range and lies inside the grid. Every start cell is seen from exactly
+// one accepted position.
+static bool recordLineMatch(const Grid* grid, const GridLines* lines, int family,
+                            int line, int p, Direction dir, int word,
+                            SearchHit** hits, int* numHits, int* capacity) {
+    int row, col;
+    lineCell(lines, family, line, p, &row, &col);
+
+    if (row < lines->range.start || row >= lines->range.end) return true;
+    if (col < 0 || col >= grid->cols) return true;
+
+    SearchHit hit = {word, row, col, dir};
+    return pushSearchHit(hits, numHits, capacity, hit);
+}
+
+// Finds every (overlapping) occurrence of pattern in a family and records
+// it as a match of the word in dir. Reversed patterns start at the last cell.
+static bool searchFamily(const Grid* grid, const GridLines* lines, int family,
+                         const char* pattern, int len, bool reversed, int word,
+                         SearchHit** hits, int* numHits, int* capacity) {
+    const LineFamily* lineFamily = &lines->families[family];
+    const char* data = lineFamily->data;
+    size_t total = (size_t)lineFamily->lineCount * (lineFamily->lineLength + 1);
+    Direction dir = reversed ? lineFamily->reverse : lineFamily->forward;
+
+    const char* from = data;
+    const char* found;
+    while ((found = memmem(from, total - (from - data), pattern, len)) != NULL) {
+        size_t offset = found - data;
+        int line = offset / (lineFamily->lineLength + 1);
+        int p = offset % (lineFamily->lineLength + 1);
+
+        if (!recordLineMatch(grid, lines, family, line, reversed ? p + len - 1 : p,
+                             dir, word, hits, numHits, capacity)) {
+            return false;
+        }
+        from = found + 1;
+    }
+    return true;
+}
+
+void searchWordsLines(Grid* grid, const WordList* words, RowRange range,
+                      ProcessResults* results) {
+    int longest = words->longest;
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+    if (longest == 0 || range.start >= range.end) return;
+
+    if (searchWordsFallback(grid, words, range, results,
+                            Grid_ensureSearchLayout(grid, longest - 1))) {
+        return;
+    }
+
+    GridLines* lines = GridLines_create(grid, range, longest - 1);
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    char* reversed = (char*)malloc(longest);
+    bool ok = lines && hits && reversed;
+
+    for (int w = 0; w < words->count && ok; w++) {
+        const char* folded = WordList_folded(words, w);
+        int len = WordList_length(words, w);
+        if (len == 0) continue;
+
+        for (int i = 0; i < len; i++) {
+            reversed[i] = folded[len - 1 - i];
+        }
+
+        for (int f = 0; f < LINE_FAMILIES_COUNT && ok; f++) {
+            ok = searchFamily(grid, lines, f, folded, len, false, w, &hits, &numHits, &hitCapacity) &&
+                 searchFamily(grid, lines, f, reversed, len, true, w, &hits, &numHits, &hitCapacity);
+        }
+    }
+
+    GridLines_destroy(lines);
+    free(reversed);
+
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for line search\n");
+        free(hits);
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    appendSortedHits(grid, words, hits, numHits, results);
+    debugPrint("Line search found %d matches in rows %d to %d\n",
+               numHits, range.start, range.end - 1);
+
+    free(hits);
+}
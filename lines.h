@@ -0,0 +1,31 @@
+#ifndef LINES_H
+#define LINES_H
+
+#include "types.h"
+#include "grid.h"
+
+#define LINE_FAMILIES_COUNT FORWARD_DIRECTIONS_COUNT
+
+// One family of parallel lines (rows, columns, diagonals or anti-diagonals)
+// stored back to back, each line followed by a '\0' separator. Position p of
+// line l is cell (originRow(l) + p * dx, originCol(l) + p * dy) in the padded grid.
+typedef struct {
+    char* data;
+    int lineLength;         // Cells per line, excluding the separator
+    int lineCount;
+    Direction forward;      // Direction of increasing p
+    Direction reverse;      // Opposite direction, matched with the reversed word
+} LineFamily;
+
+typedef struct {
+    LineFamily families[LINE_FAMILIES_COUNT];
+    RowRange range;         // Rows whose cells may start a match
+    int margin;             // Extra cells on both ends of every line
+} GridLines;
+
+GridLines* GridLines_create(const Grid* grid, RowRange range, int margin);
+void GridLines_destroy(GridLines* lines);
+void searchWordsLines(Grid* grid, const WordList* words, RowRange range,
+                      ProcessResults* results);
+
+#endif // LINES_H
@@ -1,35 +1,155 @@
 #include "mpi_handler.h"
+#include "search.h"
+#include "simd_scan.h"
+#include "binary_puzzle.h"
+#include "dictionary.h"
+#include "server.h"
 #include "debug.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 void printUsage(const char* programName) {
     printf("Usage: %s [options]\n", programName);
     printf("Options:\n");
+    printf("  -i, --input <file>     Read the puzzle from file (default: stdin)\n");
     printf("  -o, --output <file>    Output results to file\n");
+    printf("  --convert <file.wsb>   Write the puzzle in binary format and exit\n");
+    printf("  --dictionary <file>    Search for the words of a compiled .wsd dictionary\n");
+    printf("  --compile-dictionary <file.wsd>\n                         Compile the input's word list and exit\n");
+    printf("  --parallel-read        Every process reads its rows of a .wsb input\n");
+    printf("  --batch                Solve every puzzle in the input, split by '---'\n");
+    printf("  --manifest <file>      Solve the puzzle files listed in file (batch)\n");
+    printf("  --group-size <n>       Processes per batch puzzle (default: auto)\n");
+    printf("  --serve <socket>       Keep the puzzle loaded and answer queries on socket\n");
     printf("  --html                 Output in HTML format\n");
+    printf("  --engine <name>        Search engine: brute (default), trie, lines,\n                         bitplane, index, rolling, anchor,\n                         folded\n");
+    printf("  --index <file.wsi>     Grid index for the index engine, reused while it\n                         matches the puzzle (implies --engine index)\n");
+    printf("  --prefilter            Skip words with a letter or letter pair/triple\n                         the grid does not contain\n");
+    printf("  --simd <level>         Candidate scan: auto (default), avx2, sse2, scalar\n");
+    printf("  --threads <n>          Search threads per process (default: 1)\n");
+    printf("  --schedule <mode>      Thread scheduling: static (default), steal\n");
+    printf("  --distribution <mode>  Grid across processes: static (default), dynamic,\n                         tiles, words, hybrid, auto\n");
     printf("  -h, --help            Show this help message\n");
 }
 
 int main(int argc, char** argv) {
     int rank, size;
-    OutputOptions options = {NULL, false};  // Initialize with defaults
+    OutputOptions options = {NULL, false, NULL, false, false, NULL, 0, NULL, NULL, NULL};  // Initialize with defaults
+    SearchOptions searchOptions = {ENGINE_BRUTE, 1, SCHEDULE_STATIC, DISTRIBUTION_STATIC, false};
+    const char* convertFile = NULL;
+    const char* compileFile = NULL;
 
     // Process command line arguments
     for (int i = 1; i < argc; i++) {
-        if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
+        if (strcmp(argv[i], "-i") == 0 || strcmp(argv[i], "--input") == 0) {
+            if (i + 1 < argc) {
+                options.inputFile = argv[++i];
+            }
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "--output") == 0) {
             if (i + 1 < argc) {
                 options.outputFile = argv[++i];
                 printf("Output will be written to: %s\n", options.outputFile);
             }
+        } else if (strcmp(argv[i], "--convert") == 0) {
+            if (i + 1 < argc) {
+                convertFile = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--dictionary") == 0) {
+            if (i + 1 < argc) {
+                options.dictionaryFile = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--compile-dictionary") == 0) {
+            if (i + 1 < argc) {
+                compileFile = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--parallel-read") == 0) {
+            options.parallelRead = true;
+        } else if (strcmp(argv[i], "--batch") == 0) {
+            options.batch = true;
+        } else if (strcmp(argv[i], "--manifest") == 0) {
+            if (i + 1 < argc) {
+                options.manifestFile = argv[++i];
+                options.batch = true;
+            }
+        } else if (strcmp(argv[i], "--group-size") == 0) {
+            if (i + 1 < argc) {
+                options.groupSize = atoi(argv[++i]);
+                if (options.groupSize < 1) {
+                    fprintf(stderr, "Error: --group-size needs a positive count\n");
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            if (i + 1 < argc) {
+                options.serveSocket = argv[++i];
+            }
+        } else if (strcmp(argv[i], "--index") == 0) {
+            if (i + 1 < argc) {
+                options.indexFile = argv[++i];
+                searchOptions.engine = ENGINE_INDEX;
+            }
+        } else if (strcmp(argv[i], "--prefilter") == 0) {
+            searchOptions.prefilter = true;
         } else if (strcmp(argv[i], "--html") == 0) {
             options.useHTML = true;
             printf("Using HTML format\n");
+        } else if (strcmp(argv[i], "--engine") == 0) {
+            if (i + 1 < argc && !parseSearchEngine(argv[++i], &searchOptions.engine)) {
+                fprintf(stderr, "Error: Unknown search engine '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            if (i + 1 < argc) {
+                searchOptions.threads = atoi(argv[++i]);
+                if (searchOptions.threads < 1) {
+                    fprintf(stderr, "Error: --threads needs a positive count\n");
+                    return 1;
+                }
+            }
+        } else if (strcmp(argv[i], "--schedule") == 0) {
+            if (i + 1 < argc && !parseSchedule(argv[++i], &searchOptions.schedule)) {
+                fprintf(stderr, "Error: Unknown schedule '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--distribution") == 0) {
+            if (i + 1 < argc && !parseDistribution(argv[++i], &searchOptions.distribution)) {
+                fprintf(stderr, "Error: Unknown distribution '%s'\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--simd") == 0) {
+            if (i + 1 < argc && !selectCandidateScan(argv[++i])) {
+                fprintf(stderr, "Error: Unknown SIMD level '%s'\n", argv[i]);
+                return 1;
+            }
         } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             printUsage(argv[0]);
             return 0;
         }
     }
 
+    // Conversion is a single-process job done before MPI starts
+    if (convertFile) {
+        return convertPuzzle(options.inputFile, convertFile) ? 0 : 1;
+    }
+    if (compileFile) {
+        return compileDictionary(options.inputFile, compileFile) ? 0 : 1;
+    }
+
+    if (options.parallelRead && !options.inputFile) {
+        fprintf(stderr, "Error: --parallel-read needs the puzzle path given with -i\n");
+        return 1;
+    }
+    if (options.parallelRead && options.batch) {
+        fprintf(stderr, "Error: --parallel-read reads one puzzle and cannot be used in batch mode\n");
+        return 1;
+    }
+
+    if (options.serveSocket && (options.batch || options.parallelRead)) {
+        fprintf(stderr, "Error: --serve loads one puzzle and cannot be used with --batch or --parallel-read\n");
+        return 1;
+    }
+
     // Initialize MPI
     if (MPI_Init(&argc, &argv) != MPI_SUCCESS) {
         fprintf(stderr, "Error: Failed to initialize MPI\n");
@@ -49,11 +169,26 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    // Handle process based on rank
-    if (rank == 0) {
-        handleMasterProcess(rank, size, &options);
+    // Handle process based on rank. The server answers queries on its own;
+    // the other processes wait for it to stop.
+    if (options.serveSocket) {
+        if (rank == 0 && size > 1) {
+            fprintf(stderr, "Warning: --serve runs on rank 0 only; %d processes stay idle\n",
+                    size - 1);
+        }
+        if (rank == 0 && !runSearchServer(options.serveSocket, &options, &searchOptions)) {
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    } else if (options.batch) {
+        if (rank == 0) {
+            handleMasterBatch(rank, size, &options, &searchOptions);
+        } else {
+            handleWorkerBatch(rank, size, &options, &searchOptions);
+        }
+    } else if (rank == 0) {
+        handleMasterProcess(rank, size, &options, &searchOptions);
     } else {
-        handleWorkerProcess(rank, size);
+        handleWorkerProcess(rank, size, &options, &searchOptions);
     }
 
     // Finalize MPI
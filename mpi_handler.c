@@ -1,6 +1,17 @@
 #include "mpi_handler.h"
 #include "file_io.h"
+#include "puzzle_file.h"
 #include "search.h"
+#include "simd_scan.h"
+#include "scheduler.h"
+#include "dynamic.h"
+#include "tiles.h"
+#include "work_plan.h"
+#include "puzzle_groups.h"
+#include "dictionary.h"
+#include "grid_index.h"
+#include "gram_filter.h"
+#include "word_list.h"
 #include "output.h"
 #include "debug.h"
 #include "constants.h"
@@ -8,71 +19,548 @@
 #include <stdlib.h>
 #include <string.h>
 
-void syncHighlightedArrays(Grid* grid, ProcessResults* allResults, int size) {
+void syncHighlightedArrays(Grid* grid, const WordPosition* positions, int count) {
     if (grid == NULL) return;
 
     // Process each result
-    for (int proc = 0; proc < size; proc++) {
-        for (int i = 0; i < allResults[proc].validResults; i++) {
-            WordPosition pos = allResults[proc].positions[i];
-            debugPrint("DEBUG Sync: Processing word '%s' from process %d\n", pos.word, proc);
-            Grid_highlightWord(grid, pos);
+    for (int i = 0; i < count; i++) {
+        debugPrint("DEBUG Sync: Processing word '%s'\n", positions[i].word);
+        Grid_highlightWord(grid, positions[i]);
+    }
+}
+
+static MPI_Datatype createHitType(void) {
+    MPI_Datatype hitType;
+    MPI_Type_contiguous(sizeof(SearchHit), MPI_BYTE, &hitType);
+    MPI_Type_commit(&hitType);
+    return hitType;
+}
+
+// Gathers every process's hits on rank 0 of comm as compact records:
+// counts first, then one MPI_Gatherv sized to the hits actually found. The
+// root gets them in process order, with their count in totalFound; the
+// other ranks get NULL.
+static SearchHit* gatherHits(MPI_Comm comm, const ProcessResults* mine, int* totalFound) {
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
+
+    int count = mine->validResults;
+    SearchHit* hits = (SearchHit*)malloc((count > 0 ? count : 1) * sizeof(SearchHit));
+    if (!hits) {
+        fprintf(stderr, "Error: Failed to allocate memory for results in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < count; i++) {
+        const WordPosition* pos = &mine->positions[i];
+        hits[i] = (SearchHit){pos->wordIndex, pos->startRow, pos->startCol, pos->dir};
+    }
+
+    MPI_Datatype hitType = createHitType();
+    int* counts = NULL;
+    int* displs = NULL;
+    SearchHit* allHits = NULL;
+    *totalFound = 0;
+
+    if (rank == 0) {
+        counts = (int*)malloc(size * sizeof(int));
+        displs = (int*)malloc(size * sizeof(int));
+        if (!counts || !displs) {
+            fprintf(stderr, "Error: Failed to allocate memory for results\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+    }
+    MPI_Gather(&count, 1, MPI_INT, counts, 1, MPI_INT, 0, comm);
+
+    if (rank == 0) {
+        for (int proc = 0; proc < size; proc++) {
+            displs[proc] = *totalFound;
+            *totalFound += counts[proc];
+        }
+        allHits = (SearchHit*)malloc((*totalFound > 0 ? *totalFound : 1) * sizeof(SearchHit));
+        if (!allHits) {
+            fprintf(stderr, "Error: Failed to allocate memory for results\n");
+            MPI_Abort(MPI_COMM_WORLD, 1);
         }
     }
+    MPI_Gatherv(hits, count, hitType, allHits, counts, displs, hitType, 0, comm);
+    MPI_Type_free(&hitType);
+    free(hits);
+    free(displs);
+    free(counts);
+    return allHits;
+}
+
+// Rebuilds the positions of count hits from the grid and word list
+static WordPosition* hitsToPositions(const Grid* grid, const WordList* words,
+                                     const SearchHit* hits, int count) {
+    WordPosition* positions = (WordPosition*)malloc((count > 0 ? count : 1) * sizeof(WordPosition));
+    if (!positions) {
+        fprintf(stderr, "Error: Failed to allocate memory for results\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    for (int i = 0; i < count; i++) {
+        const SearchHit* hit = &hits[i];
+        setWordPosition(grid, WordList_word(words, hit->word), WordList_length(words, hit->word),
+                        hit->row, hit->col, hit->dir, &positions[i]);
+        positions[i].wordIndex = hit->word;
+    }
+    return positions;
+}
+
+// Gathers every process's results on rank 0 of comm, which gets the
+// positions in process order and their count in totalFound; the other
+// ranks pass NULL for grid and words.
+static WordPosition* gatherResults(MPI_Comm comm, const Grid* grid, const WordList* words,
+                                   const ProcessResults* mine, int* totalFound) {
+    SearchHit* hits = gatherHits(comm, mine, totalFound);
+    WordPosition* positions = hits ? hitsToPositions(grid, words, hits, *totalFound) : NULL;
+    free(hits);
+    return positions;
+}
+
+typedef struct {
+    ThreadPool* pool;
+    Grid* grid;
+    WordList words;
+    const SearchOptions* searchOptions;
+    WorkerStats* stats;     // Accumulated over every call, one entry per thread
+} LocalSearch;
+
+// Searches rows on this process with the configured threads and scheduling
+static void searchLocalRows(RowRange rows, void* context, ProcessResults* results) {
+    LocalSearch* local = (LocalSearch*)context;
+    const SearchOptions* searchOptions = local->searchOptions;
+
+    if (searchOptions->schedule != SCHEDULE_STEAL) {
+        searchWordsThreaded(local->pool, local->grid, &local->words, rows,
+                            searchOptions->engine, results);
+        return;
+    }
+
+    WorkerStats chunkStats[searchOptions->threads];
+    searchWordsStealing(local->pool, local->grid, &local->words, rows,
+                        searchOptions->engine, chunkStats, results);
+    for (int t = 0; t < local->pool->threadCount; t++) {
+        local->stats[t].busy += chunkStats[t].busy;
+        local->stats[t].idle += chunkStats[t].idle;
+        local->stats[t].tasks += chunkStats[t].tasks;
+        local->stats[t].steals += chunkStats[t].steals;
+    }
+}
+
+// Rows this process searches: every row of a tile or of a grid handed out
+// in chunks, otherwise its static share or its rows of a planned split
+static RowRange assignedRows(int rank, int size, const Grid* grid,
+                             const SearchOptions* searchOptions, const WorkPlan* plan) {
+    RowRange allRows = {0, grid->rows};
+    if (searchOptions->distribution == DISTRIBUTION_TILES ||
+        searchOptions->distribution == DISTRIBUTION_DYNAMIC) {
+        return allRows;
+    }
+    if (isPlannedDistribution(searchOptions->distribution)) {
+        return splitRowRange(allRows, rank / plan->wordParts, plan->rowParts);
+    }
+    return calculateWorkDistribution(rank, size, grid->rows);
 }
 
-void handleMasterProcess(int rank, int size, OutputOptions* options) {
+// Searches this process's part of a rows x words plan, given its rows.
+// Rank 0 gets the slowest process's search time in plan->actual.
+static void searchPlannedPart(MPI_Comm comm, int rank, RowRange rows, LocalSearch* local,
+                              WorkPlan* plan, ProcessResults* results) {
+    RowRange wordRange = splitRowRange((RowRange){0, local->words.count},
+                                       rank % plan->wordParts, plan->wordParts);
+    local->words = WordList_slice(&local->words, wordRange.start,
+                                  wordRange.end - wordRange.start);
+
+    int foundBefore = results->validResults;
+    double start = MPI_Wtime();
+    searchLocalRows(rows, local, results);
+    double elapsed = MPI_Wtime() - start;
+
+    for (int i = foundBefore; i < results->validResults; i++) {
+        results->positions[i].wordIndex += wordRange.start;
+    }
+    MPI_Reduce(&elapsed, &plan->actual, 1, MPI_DOUBLE, MPI_MAX, 0, comm);
+}
+
+// Drops the words whose letters, pairs or triples the grid lacks. Each
+// process records the grams of the rows it owns (its whole tile under the
+// tiles distribution) and the parts are OR-ed together, so every process
+// of comm keeps the same words. Returns the index in words of each kept
+// word.
+static const int* prefilterWords(MPI_Comm comm, int rank, int size, const Grid* grid,
+                                 const WordList* words, const SearchOptions* searchOptions,
+                                 Arena* arena, WordList* kept) {
+    GramFilter* filter = GramFilter_create(words->longest < 3 ? words->longest : 3);
+    if (!filter) {
+        fprintf(stderr, "Error: Failed to allocate the prefilter in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    RowRange rows = searchOptions->distribution == DISTRIBUTION_TILES
+                    ? (RowRange){0, grid->rows}
+                    : calculateWorkDistribution(rank, size, grid->rows);
+    GramFilter_addRows(filter, grid, rows);
+    MPI_Allreduce(MPI_IN_PLACE, filter->bits, GRAM_FILTER_WORDS, MPI_UINT64_T, MPI_BOR, comm);
+
+    int* original = NULL;
+    if (GramFilter_apply(filter, words, arena, kept, &original) < 0) {
+        fprintf(stderr, "Error: Failed to allocate the filtered words in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    GramFilter_destroy(filter);
+    return original;
+}
+
+// Searches this process's share of the grid, static, dynamic or planned,
+// among the processes of comm, into results held by arena. Scheduler and
+// chunk statistics are gathered into allStats / allChunks on rank 0; they
+// are NULL on the other ranks, and unused for the modes that do not report
+// them. plan is only used, and required, by the planned modes.
+static ProcessResults searchAssignedWork(MPI_Comm comm, int rank, int size, Grid* grid,
+                                         const WordList* words,
+                                         const SearchOptions* searchOptions, Arena* arena,
+                                         ThreadPool* pool, WorkerStats* allStats,
+                                         ChunkStats* allChunks, WorkPlan* plan) {
+    LocalSearch local = {
+        .pool = pool,
+        .grid = grid,
+        .words = *words,
+        .searchOptions = searchOptions,
+        .stats = (WorkerStats*)calloc(searchOptions->threads, sizeof(WorkerStats))
+    };
+    if (!local.stats) {
+        fprintf(stderr, "Error: Failed to allocate search statistics in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // Layout is shared by every chunk; build it once up front
+    Grid_ensureSearchLayout(grid, words->longest - 1);
+
+    const int* original = NULL;
+    if (searchOptions->prefilter && words->count > 0) {
+        original = prefilterWords(comm, rank, size, grid, words, searchOptions, arena,
+                                  &local.words);
+    }
+    int rejectedWords = words->count - local.words.count;
+
+    // Without a saved index, each process files only the rows it searches
+    RowRange rows = assignedRows(rank, size, grid, searchOptions, plan);
+    GridIndex* localIndex = NULL;
+    if (searchOptions->engine == ENGINE_INDEX && !grid->index && words->longest >= GRID_INDEX_K) {
+        localIndex = GridIndex_build(grid, rows);
+        grid->index = localIndex;
+    }
+
+    ProcessResults results = ProcessResults_create(arena);
+    if (searchOptions->distribution == DISTRIBUTION_DYNAMIC) {
+        ChunkStats chunks = {0, 0};
+        if (rank == 0) {
+            coordinateDynamicRows(comm, size, grid->rows, searchLocalRows, &local, &chunks, &results);
+        } else {
+            requestDynamicRows(comm, searchLocalRows, &local, &chunks, &results);
+        }
+
+        MPI_Gather(&chunks, sizeof(ChunkStats), MPI_BYTE,
+                   allChunks, sizeof(ChunkStats), MPI_BYTE, 0, comm);
+    } else if (isPlannedDistribution(searchOptions->distribution)) {
+        searchPlannedPart(comm, rank, rows, &local, plan, &results);
+    } else {
+        searchLocalRows(rows, &local, &results);
+    }
+
+    if (results.failed) {
+        fprintf(stderr, "Error: Failed to allocate memory for results in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    if (original) {
+        remapWordIndices(&results, 0, original, words);
+    }
+    results.rejectedWords = rejectedWords;
+
+    if (searchOptions->schedule == SCHEDULE_STEAL) {
+        MPI_Gather(local.stats, searchOptions->threads * sizeof(WorkerStats), MPI_BYTE,
+                   allStats, searchOptions->threads * sizeof(WorkerStats), MPI_BYTE,
+                   0, comm);
+    }
+
+    if (localIndex) {
+        grid->index = NULL;
+        GridIndex_destroy(localIndex);
+    }
+    free(local.stats);
+    return results;
+}
+
+// Searches this process's tile of a rows x cols grid. Only rank 0 passes
+// the full grid, unless file is given and every process reads its own
+// tile; every process ends up holding its tile and ghost border.
+static ProcessResults searchTile(MPI_Comm comm, int rank, int size, const Grid* grid, int rows, int cols,
+                                 const WordList* words, const SearchOptions* searchOptions,
+                                 Arena* arena, ThreadPool* pool, WorkerStats* allStats,
+                                 TileStats* allTiles, PuzzleFile* file) {
+    TileLayout layout;
+    if (!TileLayout_create(comm, rows, cols, words->longest - 1, &layout)) {
+        fprintf(stderr, "Error: Failed to create process grid in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    Grid* tile = file ? PuzzleFile_readTile(file, layout.rows, layout.cols, layout.halo)
+                      : scatterTiles(grid, &layout);
+    if (!tile) {
+        fprintf(stderr, "Error: Failed to create tile in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    ProcessResults results = searchAssignedWork(comm, rank, size, tile, words, searchOptions,
+                                                arena, pool, allStats, NULL, NULL);
+    offsetResults(&results, layout.rows.start, layout.cols.start, rows, cols);
+
+    TileStats stats = {
+        .rows = layout.rows,
+        .cols = layout.cols,
+        .halo = layout.halo,
+        .cells = (long)tile->stride * (tile->rows + 2 * tile->halo)
+    };
+    MPI_Gather(&stats, sizeof(TileStats), MPI_BYTE,
+               allTiles, sizeof(TileStats), MPI_BYTE, 0, comm);
+
+    Grid_destroy(tile);
+    TileLayout_destroy(&layout);
+    return results;
+}
+
+// Searches this process's share of a puzzle broadcast by rank 0 of comm:
+// its tile under the tiles distribution (grid is NULL outside rank 0),
+// otherwise the rows or words assigned to it
+static ProcessResults searchPuzzle(MPI_Comm comm, int rank, int size, Grid* grid,
+                                   int rows, int cols, const WordList* words,
+                                   const SearchOptions* searchOptions, Arena* arena,
+                                   ThreadPool* pool, WorkerStats* allStats,
+                                   ChunkStats* allChunks, TileStats* allTiles, WorkPlan* plan) {
+    if (searchOptions->distribution == DISTRIBUTION_TILES) {
+        return searchTile(comm, rank, size, grid, rows, cols, words, searchOptions, arena, pool,
+                          allStats, allTiles, NULL);
+    }
+    return searchAssignedWork(comm, rank, size, grid, words, searchOptions, arena, pool,
+                              allStats, allChunks, plan);
+}
+
+// Searches this process's part of a binary puzzle that every process reads
+// with MPI-IO: its tile, its static row slab (a full-width tile), or the
+// whole grid for the modes that hand out rows or words at run time
+static ProcessResults searchFromFile(int rank, int size, PuzzleFile* file, const WordList* words,
+                                     const SearchOptions* searchOptions, Arena* arena,
+                                     ThreadPool* pool, WorkerStats* allStats,
+                                     ChunkStats* allChunks, TileStats* allTiles, WorkPlan* plan) {
+    if (searchOptions->distribution == DISTRIBUTION_TILES) {
+        return searchTile(MPI_COMM_WORLD, rank, size, NULL, file->rows, file->cols, words, searchOptions,
+                          arena, pool, allStats, allTiles, file);
+    }
+
+    bool slab = searchOptions->distribution == DISTRIBUTION_STATIC;
+    RowRange rows = slab ? calculateWorkDistribution(rank, size, file->rows)
+                         : (RowRange){0, file->rows};
+    Grid* grid = PuzzleFile_readTile(file, rows, (RowRange){0, file->cols}, words->longest - 1);
+    if (!grid) {
+        fprintf(stderr, "Error: Failed to read grid rows in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+
+    // A slab is all this process searches, as with a tile
+    SearchOptions localOptions = *searchOptions;
+    if (slab) localOptions.distribution = DISTRIBUTION_TILES;
+
+    ProcessResults results = searchAssignedWork(MPI_COMM_WORLD, rank, size, grid, words,
+                                                &localOptions, arena, pool, allStats,
+                                                allChunks, plan);
+    if (slab) offsetResults(&results, rows.start, 0, file->rows, file->cols);
+
+    Grid_destroy(grid);
+    return results;
+}
+
+// Sums the start positions the anchor engine tried, and those the first
+// letter would have given, into totals on rank 0 (NULL elsewhere)
+static void reduceCandidates(const SearchOptions* searchOptions, const ProcessResults* mine,
+                             long* totals) {
+    if (searchOptions->engine != ENGINE_ANCHOR) return;
+
+    long counts[2] = {mine->candidates, mine->firstLetterCandidates};
+    MPI_Reduce(counts, totals, 2, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+}
+
+// Maps the compiled dictionary named in options, if any. Every process maps
+// it itself, so processes on one node share its pages.
+static void openDictionary(int rank, const OutputOptions* options, Dictionary* dictionary) {
+    memset(dictionary, 0, sizeof(Dictionary));
+    if (options && options->dictionaryFile &&
+        !Dictionary_open(options->dictionaryFile, dictionary)) {
+        fprintf(stderr, "Error: Failed to load the dictionary in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+}
+
+// Words a puzzle carries to other processes: none when they all map the
+// same dictionary
+static const WordList* wordsToSend(const Dictionary* dictionary, const WordList* words) {
+    static const WordList noWords = {0};
+    return dictionary->mapping ? &noWords : words;
+}
+
+// Replaces received (empty) words with the dictionary's
+static void useDictionaryWords(const Dictionary* dictionary, WordList* words) {
+    if (dictionary->mapping) *words = dictionary->words;
+}
+
+void handleMasterProcess(int rank, int size, OutputOptions* options,
+                        const SearchOptions* searchOptions) {
     double startTime = MPI_Wtime();
 
-    // Initialize master process and read input
-    char words[MAX_WORDS][MAX_WORD_LENGTH];
-    int numWords;
-    Grid* grid = readPuzzleFromFile();
+    // Initialize master process and read input; words and results live in
+    // one arena freed at the end of the run
+    Arena* arena = Arena_create(0);
+    ThreadPool* pool = ThreadPool_create(searchOptions->threads);
+    WordList words;
+    PuzzleInput input;
+    const char* inputFile = options ? options->inputFile : NULL;
 
+    if (!pool) {
+        fprintf(stderr, "Error: Failed to start search threads in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+
+    if (!PuzzleInput_open(inputFile, &input)) {
+        fprintf(stderr, "Error: Failed to open puzzle %s\n", inputFile ? inputFile : "from stdin");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+
+    // Parallel reads need a binary puzzle, whose rows sit at known offsets
+    bool parallelRead = options && options->parallelRead;
+    if (parallelRead && !isBinaryPuzzle(&input)) {
+        fprintf(stderr, "Error: --parallel-read needs a binary (.wsb) puzzle\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+
+    // A binary puzzle's grid stays in the mapped input, so input is kept
+    // open for the whole run
+    Grid* grid = arena ? readPuzzle(&input, arena, &words) : NULL;
     if (!grid) {
         fprintf(stderr, "Error: Failed to read puzzle\n");
         MPI_Abort(MPI_COMM_WORLD, 1);
         return;
     }
 
-    readWordsFromFile(words, &numWords);
+    // A compiled dictionary replaces the puzzle's own words
+    Dictionary dictionary;
+    openDictionary(rank, options, &dictionary);
+    useDictionaryWords(&dictionary, &words);
 
     // Print initial information
     printf("\nPuzzle Information:\n");
     printf("------------------\n");
     printf("Grid dimensions: %d columns x %d rows\n", grid->cols, grid->rows);
-    printf("Number of words to search: %d\n", numWords);
-    printf("Words to find: ");
-    for (int i = 0; i < numWords; i++) {
-        printf("%s", words[i]);
-        if (i < numWords - 1) printf(", ");
+    printf("Number of words to search: %d\n", words.count);
+    if (dictionary.mapping) {
+        printf("Words from: dictionary %s (%zu bytes mapped)\n", options->dictionaryFile,
+               dictionary.size);
+    }
+    printf("Search engine: %s\n", SEARCH_ENGINE_NAMES[searchOptions->engine]);
+    printf("Candidate scan: %s\n", candidateScanName());
+    printf("Threads per process: %d (%s schedule)\n", searchOptions->threads,
+           SCHEDULE_NAMES[searchOptions->schedule]);
+    printf("Row distribution: %s\n", DISTRIBUTION_NAMES[searchOptions->distribution]);
+    printf("Grid input: %s\n", parallelRead ? "MPI-IO, each process reads its rows"
+                                            : "read by rank 0");
+    if (!dictionary.mapping) {
+        printf("Words to find: ");
+        for (int i = 0; i < words.count; i++) {
+            printf("%s", WordList_word(&words, i));
+            if (i < words.count - 1) printf(", ");
+        }
+        printf("\n");
     }
-    printf("\n\n");
+    printf("\n");
 
-    // Broadcast data to all processes
-    broadcastGridData(grid, numWords, words);
+    // The index engine files the whole grid once, reusing a saved index
+    // that matches it; tiles and row slabs read from the file are indexed
+    // where they are searched instead
+    bool tiled = searchOptions->distribution == DISTRIBUTION_TILES;
+    GridIndex* index = NULL;
+    double indexSeconds = 0.0;
+    if (searchOptions->engine == ENGINE_INDEX && !tiled && !parallelRead) {
+        double indexStart = MPI_Wtime();
+        index = GridIndex_open(grid, options ? options->indexFile : NULL, true);
+        indexSeconds = MPI_Wtime() - indexStart;
+        grid->index = index;
+    }
 
-    // Calculate work distribution
-    RowRange range = calculateWorkDistribution(rank, size, grid->rows);
+    // Price every rows x words split before the workers get the grid
+    bool planned = isPlannedDistribution(searchOptions->distribution);
+    WorkPlan plan = {size, 1, 0.0, 0.0};
+    WorkPlan* plans = (WorkPlan*)calloc(size, sizeof(WorkPlan));
+    int numPlans = 0;
+    if (!plans) {
+        fprintf(stderr, "Error: Failed to allocate memory for work plans\n");
+        Grid_destroy(grid);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+    if (planned) {
+        numPlans = listWorkPlans(grid, &words, size, searchOptions, plans);
+        plan = chooseWorkPlan(plans, numPlans, searchOptions->distribution);
+    }
 
-    // Search words in master's portion
-    ProcessResults myResults = searchWords(grid, words, numWords, range);
+    // Broadcast data to all processes; tiled runs send each process its tile
+    // later, and parallel reads leave the workers to read the file
+    if (!parallelRead) {
+        broadcastGridData(MPI_COMM_WORLD, grid, wordsToSend(&dictionary, &words), !tiled);
+    }
+    if (planned) {
+        MPI_Bcast(&plan, sizeof(WorkPlan), MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
 
-    // Gather all results
-    ProcessResults* allResults = (ProcessResults*)malloc(size * sizeof(ProcessResults));
-    if (!allResults) {
-        fprintf(stderr, "Error: Failed to allocate memory for results\n");
+    // Search words in master's portion
+    WorkerStats* allStats = (WorkerStats*)calloc((size_t)size * searchOptions->threads,
+                                                 sizeof(WorkerStats));
+    ChunkStats* allChunks = (ChunkStats*)calloc(size, sizeof(ChunkStats));
+    TileStats* allTiles = (TileStats*)calloc(size, sizeof(TileStats));
+    if (!allStats || !allChunks || !allTiles) {
+        fprintf(stderr, "Error: Failed to allocate memory for process statistics\n");
         Grid_destroy(grid);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return;
     }
+    PuzzleFile file;
+    if (parallelRead && !PuzzleFile_open(inputFile, arena, NULL, &file)) {
+        fprintf(stderr, "Error: Failed to open %s with MPI-IO\n", inputFile);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
 
-    MPI_Gather(&myResults, sizeof(ProcessResults), MPI_BYTE,
-               allResults, sizeof(ProcessResults), MPI_BYTE,
-               0, MPI_COMM_WORLD);
+    double searchStart = MPI_Wtime();
+    ProcessResults myResults = parallelRead
+        ? searchFromFile(rank, size, &file, &words, searchOptions, arena, pool,
+                         allStats, allChunks, allTiles, &plan)
+        : searchPuzzle(MPI_COMM_WORLD, rank, size, grid, grid->rows, grid->cols, &words,
+                       searchOptions, arena, pool, allStats, allChunks, allTiles, &plan);
+    if (parallelRead) {
+        PuzzleFile_close(&file);
+    }
+
+    // Gather all results
+    int totalFound;
+    WordPosition* found = gatherResults(MPI_COMM_WORLD, grid, &words, &myResults, &totalFound);
+    double searchSeconds = MPI_Wtime() - searchStart;
+    long candidates[2] = {0, 0};
+    reduceCandidates(searchOptions, &myResults, candidates);
 
     // Synchronize highlighted arrays
-    syncHighlightedArrays(grid, allResults, size);
+    syncHighlightedArrays(grid, found, totalFound);
 
     // Process and display results
     printf("\nSearch Results:\n");
@@ -85,75 +573,639 @@ void handleMasterProcess(int rank, int size, OutputOptions* options) {
     }
 
     printf("\nFound Words:\n");
-    int totalFound = 0;
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < allResults[i].validResults; j++) {
-            printFoundWord(&allResults[i].positions[j]);
-            totalFound++;
-        }
+    for (int i = 0; i < totalFound; i++) {
+        printFoundWord(&found[i]);
     }
 
     // Print execution time
     double endTime = MPI_Wtime();
     printPerformanceMetrics(totalFound, startTime, endTime, size);
+    if (searchOptions->distribution == DISTRIBUTION_DYNAMIC) {
+        printChunkStats(allChunks, size);
+    }
+    if (tiled) {
+        printTileStats(allTiles, size, (long)grid->rows * grid->cols);
+    }
+    if (planned) {
+        printWorkPlans(plans, numPlans, &plan);
+    }
+    if (searchOptions->schedule == SCHEDULE_STEAL) {
+        printWorkerStats(allStats, size, searchOptions->threads);
+    }
+    if (searchOptions->engine == ENGINE_ANCHOR) {
+        printAnchorStats(candidates[0], candidates[1]);
+    }
+    if (searchOptions->prefilter) {
+        printPrefilterStats(myResults.rejectedWords, words.count);
+    }
+    if (index) {
+        printIndexMetrics(index, options ? options->indexFile : NULL, indexSeconds,
+                          searchSeconds, GridIndex_candidates(index, &words),
+                          (long)grid->rows * grid->cols * DIRECTIONS_COUNT * words.count);
+    }
 
     // Cleanup
-    free(allResults);
+    free(plans);
+    free(allTiles);
+    free(allChunks);
+    free(allStats);
+    free(found);
     Grid_destroy(grid);
+    GridIndex_destroy(index);
+    Dictionary_close(&dictionary);
+    PuzzleInput_close(&input);
+    ThreadPool_destroy(pool);
+    Arena_destroy(arena);
 }
 
-void handleWorkerProcess(int rank, int size) {
-    // Receive grid dimensions and data
-    int rows, cols, numWords;
-    MPI_Bcast(&rows, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&cols, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&numWords, 1, MPI_INT, 0, MPI_COMM_WORLD);
-
-    // Create grid
-    Grid* grid = Grid_create(rows, cols);
-    if (!grid) {
+void handleWorkerProcess(int rank, int size, const OutputOptions* options,
+                         const SearchOptions* searchOptions) {
+    // Receive grid dimensions, data and words in one broadcast. Tiled runs
+    // never hold the whole grid outside rank 0, and parallel reads take
+    // everything from the file instead.
+    bool parallelRead = options->parallelRead;
+    Arena* arena = Arena_create(0);
+    ThreadPool* pool = ThreadPool_create(searchOptions->threads);
+    WordList words;
+    int rows, cols;
+    Grid* grid = NULL;
+    if (!pool) {
+        fprintf(stderr, "Error: Failed to start search threads in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+    if (!arena || (!parallelRead &&
+                   !receiveGridData(MPI_COMM_WORLD, &grid, &rows, &cols, arena, &words))) {
         fprintf(stderr, "Error: Failed to create grid in worker process %d\n", rank);
         MPI_Abort(MPI_COMM_WORLD, 1);
         return;
     }
 
-    // Receive grid data and words
-    char words[MAX_WORDS][MAX_WORD_LENGTH];
-    for (int i = 0; i < rows; i++) {
-        MPI_Bcast(grid->letters[i], cols, MPI_CHAR, 0, MPI_COMM_WORLD);
-    }
+    Dictionary dictionary;
+    openDictionary(rank, options, &dictionary);
+    useDictionaryWords(&dictionary, &words);
 
-    for (int i = 0; i < numWords; i++) {
-        MPI_Bcast(words[i], MAX_WORD_LENGTH, MPI_CHAR, 0, MPI_COMM_WORLD);
+    // Rank 0 has saved the index by now, so a matching file is mapped;
+    // without one, the search indexes only this process's rows
+    GridIndex* index = NULL;
+    if (searchOptions->engine == ENGINE_INDEX && grid && options && options->indexFile &&
+        searchOptions->distribution != DISTRIBUTION_TILES) {
+        index = GridIndex_load(options->indexFile, grid);
+        grid->index = index;
     }
 
-    // Calculate work distribution
-    RowRange range = calculateWorkDistribution(rank, size, rows);
+    WorkPlan plan;
+    if (isPlannedDistribution(searchOptions->distribution)) {
+        MPI_Bcast(&plan, sizeof(WorkPlan), MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
 
     // Search words in worker's portion
-    ProcessResults myResults = searchWords(grid, words, numWords, range);
+    PuzzleFile file;
+    ProcessResults myResults;
+    if (parallelRead) {
+        if (!PuzzleFile_open(options->inputFile, arena, dictionary.mapping ? NULL : &words,
+                             &file)) {
+            fprintf(stderr, "Error: Failed to open %s with MPI-IO in process %d\n",
+                    options->inputFile, rank);
+            MPI_Abort(MPI_COMM_WORLD, 1);
+            return;
+        }
+        myResults = searchFromFile(rank, size, &file, &words, searchOptions, arena, pool,
+                                   NULL, NULL, NULL, &plan);
+        PuzzleFile_close(&file);
+    } else {
+        myResults = searchPuzzle(MPI_COMM_WORLD, rank, size, grid, rows, cols, &words,
+                                 searchOptions, arena, pool, NULL, NULL, NULL, &plan);
+    }
 
     // Send results back to master
-    MPI_Gather(&myResults, sizeof(ProcessResults), MPI_BYTE,
-               NULL, sizeof(ProcessResults), MPI_BYTE,
-               0, MPI_COMM_WORLD);
+    int totalFound;
+    gatherResults(MPI_COMM_WORLD, NULL, NULL, &myResults, &totalFound);
+    reduceCandidates(searchOptions, &myResults, NULL);
 
     // Cleanup
     Grid_destroy(grid);
+    GridIndex_destroy(index);
+    Dictionary_close(&dictionary);
+    ThreadPool_destroy(pool);
+    Arena_destroy(arena);
+}
+
+// Largest block in the broadcast datatype; keeps MPI's int counts in range
+#define BROADCAST_BLOCK_BYTES (1 << 30)
+
+// Sent first so workers can allocate before the payload arrives
+typedef struct {
+    int rows;
+    int cols;
+    int numWords;
+    int hasGrid;        // 0 when the grid is scattered as tiles instead
+    long wordBytes;     // Size of the length-prefixed word table
+} BroadcastHeader;
+
+// Datatype for the flat grid followed by the word table. A struct over
+// absolute addresses moves both straight from (and into) their own
+// buffers, split into blocks small enough for int counts. False when there
+// is nothing to move.
+static bool createPayloadType(char* cells, size_t cellBytes, char* table, size_t tableBytes,
+                              MPI_Datatype* payload) {
+    int maxBlocks = (int)(cellBytes / BROADCAST_BLOCK_BYTES + tableBytes / BROADCAST_BLOCK_BYTES) + 2;
+    int lengths[maxBlocks];
+    MPI_Aint offsets[maxBlocks];
+    MPI_Datatype types[maxBlocks];
+    int blocks = 0;
+
+    char* parts[2] = {cells, table};
+    size_t sizes[2] = {cellBytes, tableBytes};
+    for (int p = 0; p < 2; p++) {
+        for (size_t done = 0; done < sizes[p]; done += lengths[blocks - 1]) {
+            size_t left = sizes[p] - done;
+            lengths[blocks] = left < BROADCAST_BLOCK_BYTES ? (int)left : BROADCAST_BLOCK_BYTES;
+            MPI_Get_address(parts[p] + done, &offsets[blocks]);
+            types[blocks] = MPI_CHAR;
+            blocks++;
+        }
+    }
+    if (blocks == 0) return false;
+
+    MPI_Type_create_struct(blocks, lengths, offsets, types, payload);
+    MPI_Type_commit(payload);
+    return true;
+}
+
+// Header and packed word table for sending a grid and its words; the
+// caller frees the table
+static char* packGridData(const Grid* grid, const WordList* words, bool includeGrid,
+                          BroadcastHeader* header) {
+    *header = (BroadcastHeader){
+        .rows = grid->rows,
+        .cols = grid->cols,
+        .numWords = words->count,
+        .hasGrid = includeGrid,
+        .wordBytes = WordList_tableBytes(words)
+    };
+
+    char* table = (char*)malloc(header->wordBytes > 0 ? header->wordBytes : 1);
+    if (!table) {
+        fprintf(stderr, "Error: Failed to allocate memory for the word table\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    WordList_pack(words, table);
+    return table;
+}
+
+// Grid and word table buffers for the payload a header announces
+static bool prepareGridData(const BroadcastHeader* header, Grid** grid, char** table) {
+    *grid = NULL;
+    *table = (char*)malloc(header->wordBytes > 0 ? header->wordBytes : 1);
+    if (header->hasGrid) {
+        *grid = Grid_create(header->rows, header->cols);
+    }
+    if (!*table || (header->hasGrid && !*grid)) {
+        free(*table);
+        Grid_destroy(*grid);
+        *grid = NULL;
+        return false;
+    }
+    return true;
+}
+
+// Words from a received table; the grid is dropped if they do not unpack
+static bool unpackGridData(const BroadcastHeader* header, Grid** grid, char* table,
+                           Arena* arena, WordList* words) {
+    bool unpacked = WordList_unpack(words, arena, header->numWords, table, header->wordBytes);
+    free(table);
+    if (!unpacked) {
+        Grid_destroy(*grid);
+        *grid = NULL;
+    }
+    return unpacked;
+}
+
+static size_t gridDataCells(const BroadcastHeader* header) {
+    return header->hasGrid ? (size_t)header->rows * header->cols : 0;
+}
+
+// One broadcast of the grid and word table from rank 0 of comm
+static void broadcastPayload(MPI_Comm comm, char* cells, size_t cellBytes,
+                             char* table, size_t tableBytes) {
+    MPI_Datatype payload;
+    if (createPayloadType(cells, cellBytes, table, tableBytes, &payload)) {
+        MPI_Bcast(MPI_BOTTOM, 1, payload, 0, comm);
+        MPI_Type_free(&payload);
+    }
+}
+
+void broadcastGridData(MPI_Comm comm, Grid* grid, const WordList* words, bool includeGrid) {
+    BroadcastHeader header;
+    char* table = packGridData(grid, words, includeGrid, &header);
+
+    MPI_Bcast(&header, sizeof(BroadcastHeader), MPI_BYTE, 0, comm);
+    broadcastPayload(comm, grid->letters[0], gridDataCells(&header), table, header.wordBytes);
+    free(table);
+}
+
+bool receiveGridData(MPI_Comm comm, Grid** grid, int* rows, int* cols, Arena* arena,
+                     WordList* words) {
+    BroadcastHeader header;
+    MPI_Bcast(&header, sizeof(BroadcastHeader), MPI_BYTE, 0, comm);
+    *rows = header.rows;
+    *cols = header.cols;
+
+    char* table;
+    if (!prepareGridData(&header, grid, &table)) return false;
+
+    broadcastPayload(comm, header.hasGrid ? (*grid)->letters[0] : NULL, gridDataCells(&header),
+                     table, header.wordBytes);
+    return unpackGridData(&header, grid, table, arena, words);
+}
+
+// Point-to-point counterparts of the broadcast above, for handing a whole
+// puzzle to one process
+static void sendGridData(int dest, int tag, Grid* grid, const WordList* words) {
+    BroadcastHeader header;
+    char* table = packGridData(grid, words, true, &header);
+
+    MPI_Send(&header, sizeof(BroadcastHeader), MPI_BYTE, dest, tag, MPI_COMM_WORLD);
+    MPI_Datatype payload;
+    if (createPayloadType(grid->letters[0], gridDataCells(&header), table, header.wordBytes,
+                          &payload)) {
+        MPI_Send(MPI_BOTTOM, 1, payload, dest, tag, MPI_COMM_WORLD);
+        MPI_Type_free(&payload);
+    }
+    free(table);
+}
+
+static bool recvGridData(int source, int tag, Grid** grid, Arena* arena, WordList* words) {
+    BroadcastHeader header;
+    MPI_Recv(&header, sizeof(BroadcastHeader), MPI_BYTE, source, tag, MPI_COMM_WORLD,
+             MPI_STATUS_IGNORE);
+
+    char* table;
+    if (!prepareGridData(&header, grid, &table)) return false;
+
+    MPI_Datatype payload;
+    if (createPayloadType(header.hasGrid ? (*grid)->letters[0] : NULL, gridDataCells(&header),
+                          table, header.wordBytes, &payload)) {
+        MPI_Recv(MPI_BOTTOM, 1, payload, source, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        MPI_Type_free(&payload);
+    }
+    return unpackGridData(&header, grid, table, arena, words);
+}
+
+// Puzzles read ahead per process; each window is shared out among groups
+#define BATCH_WINDOW_PER_PROCESS 4
+
+// A puzzle of the current window, held by rank 0 and by the leader of the
+// group solving it
+typedef struct {
+    Grid* grid;
+    WordList words;
+    const char* name;       // Manifest entry, or NULL
+    int found;
+    double seconds;
+    SearchHit* hits;        // Filled in on the leader, then on rank 0
+} BatchPuzzle;
+
+// Sent from rank 0 before each window; count is 0 once the batch is done
+typedef struct {
+    int count;
+    int numGroups;
+} BatchWindow;
+
+// Sent by a group leader to rank 0 ahead of a puzzle's hits
+typedef struct {
+    int found;
+    double seconds;
+} BatchResult;
+
+// State every process keeps across a batch
+typedef struct {
+    const SearchOptions* searchOptions;
+    Dictionary dictionary;  // Words of every puzzle when one is given
+    ThreadPool* pool;
+    Arena* arena;           // Words and results of the puzzle being solved
+    Arena* windowArena;     // Words of the puzzles held for the window
+    WorkerStats* allStats;  // Statistics are gathered for every puzzle but not printed
+    ChunkStats* allChunks;
+    TileStats* allTiles;
+    WorkPlan* plans;
+    BatchPuzzle* puzzles;   // One entry per window position
+    int* assignment;        // Group of each puzzle in the window
+    MPI_Comm group;
+    int numGroups;          // Groups the communicator was split for, 0 before the first
+} BatchSolver;
+
+static void createBatchSolver(int rank, int size, const OutputOptions* options,
+                              const SearchOptions* searchOptions, BatchSolver* solver) {
+    int windowSize = BATCH_WINDOW_PER_PROCESS * size;
+    *solver = (BatchSolver){
+        .searchOptions = searchOptions,
+        .pool = ThreadPool_create(searchOptions->threads),
+        .arena = Arena_create(0),
+        .windowArena = Arena_create(0),
+        .allStats = (WorkerStats*)calloc((size_t)size * searchOptions->threads, sizeof(WorkerStats)),
+        .allChunks = (ChunkStats*)calloc(size, sizeof(ChunkStats)),
+        .allTiles = (TileStats*)calloc(size, sizeof(TileStats)),
+        .plans = (WorkPlan*)calloc(size, sizeof(WorkPlan)),
+        .puzzles = (BatchPuzzle*)calloc(windowSize, sizeof(BatchPuzzle)),
+        .assignment = (int*)calloc(windowSize, sizeof(int)),
+        .group = MPI_COMM_NULL,
+        .numGroups = 0
+    };
+
+    if (!solver->pool || !solver->arena || !solver->windowArena || !solver->allStats ||
+        !solver->allChunks || !solver->allTiles || !solver->plans || !solver->puzzles ||
+        !solver->assignment) {
+        fprintf(stderr, "Error: Failed to start search threads in process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
+    openDictionary(rank, options, &solver->dictionary);
+}
+
+static void destroyBatchSolver(BatchSolver* solver) {
+    Dictionary_close(&solver->dictionary);
+    if (solver->group != MPI_COMM_NULL) MPI_Comm_free(&solver->group);
+    free(solver->assignment);
+    free(solver->puzzles);
+    free(solver->plans);
+    free(solver->allTiles);
+    free(solver->allChunks);
+    free(solver->allStats);
+    ThreadPool_destroy(solver->pool);
+    Arena_destroy(solver->windowArena);
+    Arena_destroy(solver->arena);
+}
+
+// Splits the processes into numGroups groups, keeping the current split
+// when the count has not changed
+static void joinBatchGroup(BatchSolver* solver, int rank, int size, int numGroups) {
+    if (solver->numGroups == numGroups) return;
+
+    if (solver->group != MPI_COMM_NULL) MPI_Comm_free(&solver->group);
+    MPI_Comm_split(MPI_COMM_WORLD, groupOfProcess(rank, size, numGroups), rank, &solver->group);
+    solver->numGroups = numGroups;
+}
+
+// Solves one puzzle with the processes of this group. The leader passes
+// the puzzle and gets its hits and search time back in it; the other
+// members pass NULL and receive the puzzle from the leader.
+static void solveInGroup(BatchSolver* solver, BatchPuzzle* puzzle) {
+    const SearchOptions* searchOptions = solver->searchOptions;
+    bool planned = isPlannedDistribution(searchOptions->distribution);
+    bool tiled = searchOptions->distribution == DISTRIBUTION_TILES;
+    int rank, size;
+    MPI_Comm_rank(solver->group, &rank);
+    MPI_Comm_size(solver->group, &size);
+
+    Arena_reset(solver->arena);
+    double start = MPI_Wtime();
+    WordList received;
+    const WordList* words = puzzle ? &puzzle->words : &received;
+    Grid* grid = puzzle ? puzzle->grid : NULL;
+    int rows = grid ? grid->rows : 0;
+    int cols = grid ? grid->cols : 0;
+
+    WorkPlan plan = {size, 1, 0.0, 0.0};
+    if (puzzle) {
+        if (planned) {
+            int numPlans = listWorkPlans(grid, words, size, searchOptions, solver->plans);
+            plan = chooseWorkPlan(solver->plans, numPlans, searchOptions->distribution);
+        }
+        broadcastGridData(solver->group, grid, wordsToSend(&solver->dictionary, words), !tiled);
+    } else if (!receiveGridData(solver->group, &grid, &rows, &cols, solver->arena, &received)) {
+        fprintf(stderr, "Error: Failed to create grid in worker process %d\n", rank);
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    } else {
+        useDictionaryWords(&solver->dictionary, &received);
+    }
+    if (planned) {
+        MPI_Bcast(&plan, sizeof(WorkPlan), MPI_BYTE, 0, solver->group);
+    }
+
+    ProcessResults myResults = searchPuzzle(solver->group, rank, size, grid, rows, cols, words,
+                                            searchOptions, solver->arena, solver->pool,
+                                            solver->allStats, solver->allChunks,
+                                            solver->allTiles, &plan);
+    int found;
+    SearchHit* hits = gatherHits(solver->group, &myResults, &found);
+
+    if (puzzle) {
+        puzzle->hits = hits;
+        puzzle->found = found;
+        puzzle->seconds = MPI_Wtime() - start;
+    } else {
+        Grid_destroy(grid);
+    }
 }
 
-void broadcastGridData(Grid* grid, int numWords, char words[][MAX_WORD_LENGTH]) {
-    MPI_Bcast(&grid->rows, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&grid->cols, 1, MPI_INT, 0, MPI_COMM_WORLD);
-    MPI_Bcast(&numWords, 1, MPI_INT, 0, MPI_COMM_WORLD);
+// Solves the count puzzles of a window: rank 0 hands each puzzle to the
+// leader of its group, every group works through its own puzzles in
+// order, and the leaders send the hits back to rank 0
+static void solveBatchWindow(BatchSolver* solver, int rank, int size, int count) {
+    int numGroups = solver->numGroups;
+    int myGroup = groupOfProcess(rank, size, numGroups);
+    bool leader = groupLeader(myGroup, size, numGroups) == rank;
+    BatchPuzzle* puzzles = solver->puzzles;
+    const int* assignment = solver->assignment;
 
-    for (int i = 0; i < grid->rows; i++) {
-        MPI_Bcast(grid->letters[i], grid->cols, MPI_CHAR, 0, MPI_COMM_WORLD);
+    // Leaders take all their puzzles before searching any, so rank 0 never
+    // waits on a search to hand out the next one
+    for (int p = 0; p < count; p++) {
+        int dest = groupLeader(assignment[p], size, numGroups);
+        if (rank == 0 && dest != 0) {
+            sendGridData(dest, TAG_BATCH_PUZZLE, puzzles[p].grid,
+                         wordsToSend(&solver->dictionary, &puzzles[p].words));
+        } else if (rank != 0 && dest == rank) {
+            if (!recvGridData(0, TAG_BATCH_PUZZLE, &puzzles[p].grid, solver->windowArena,
+                              &puzzles[p].words)) {
+                fprintf(stderr, "Error: Failed to create grid in worker process %d\n", rank);
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            useDictionaryWords(&solver->dictionary, &puzzles[p].words);
+        }
     }
 
-    for (int i = 0; i < numWords; i++) {
-        MPI_Bcast(words[i], MAX_WORD_LENGTH, MPI_CHAR, 0, MPI_COMM_WORLD);
+    for (int p = 0; p < count; p++) {
+        if (assignment[p] == myGroup) {
+            solveInGroup(solver, leader ? &puzzles[p] : NULL);
+        }
     }
+
+    // Results reach rank 0 in window order
+    MPI_Datatype hitType = createHitType();
+    for (int p = 0; p < count; p++) {
+        BatchPuzzle* puzzle = &puzzles[p];
+        int source = groupLeader(assignment[p], size, numGroups);
+        if (rank != 0 && source == rank) {
+            BatchResult result = {puzzle->found, puzzle->seconds};
+            MPI_Send(&result, sizeof(BatchResult), MPI_BYTE, 0, TAG_BATCH_RESULT, MPI_COMM_WORLD);
+            MPI_Send(puzzle->hits, puzzle->found, hitType, 0, TAG_BATCH_RESULT, MPI_COMM_WORLD);
+        } else if (rank == 0 && source != 0) {
+            BatchResult result;
+            MPI_Recv(&result, sizeof(BatchResult), MPI_BYTE, source, TAG_BATCH_RESULT,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            puzzle->found = result.found;
+            puzzle->seconds = result.seconds;
+            puzzle->hits = (SearchHit*)malloc((result.found > 0 ? result.found : 1) *
+                                              sizeof(SearchHit));
+            if (!puzzle->hits) {
+                fprintf(stderr, "Error: Failed to allocate memory for results\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+            }
+            MPI_Recv(puzzle->hits, result.found, hitType, source, TAG_BATCH_RESULT,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+        }
+    }
+    MPI_Type_free(&hitType);
+}
+
+// Drops the window's puzzles and the memory of their words
+static void releaseBatchWindow(BatchSolver* solver, int count) {
+    for (int p = 0; p < count; p++) {
+        free(solver->puzzles[p].hits);
+        Grid_destroy(solver->puzzles[p].grid);
+    }
+    memset(solver->puzzles, 0, count * sizeof(BatchPuzzle));
+    Arena_reset(solver->windowArena);
+}
+
+static const char* copyName(Arena* arena, const char* name) {
+    size_t length = strlen(name) + 1;
+    char* copy = (char*)Arena_alloc(arena, length);
+    if (copy) memcpy(copy, name, length);
+    return copy;
+}
+
+// Solves every puzzle of the batch input, a window at a time. The
+// processes are split into groups that solve different puzzles at once;
+// unless fixed with --group-size, the split is chosen for each window
+// from the sizes of its puzzles. Results print in input order.
+void handleMasterBatch(int rank, int size, OutputOptions* options,
+                       const SearchOptions* searchOptions) {
+    double startTime = MPI_Wtime();
+    BatchSolver solver;
+    PuzzleBatch batch;
+    createBatchSolver(rank, size, options, searchOptions, &solver);
+
+    int windowSize = BATCH_WINDOW_PER_PROCESS * size;
+    PuzzleShape* shapes = (PuzzleShape*)malloc(windowSize * sizeof(PuzzleShape));
+    if (!shapes) {
+        fprintf(stderr, "Error: Failed to allocate memory for the batch\n");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+    if (!PuzzleBatch_open(options->inputFile, options->manifestFile, &batch)) {
+        const char* source = options->manifestFile ? options->manifestFile : options->inputFile;
+        fprintf(stderr, "Error: Failed to open batch input %s\n", source ? source : "from stdin");
+        MPI_Abort(MPI_COMM_WORLD, 1);
+        return;
+    }
+
+    printf("\nBatch Information:\n");
+    printf("------------------\n");
+    printf("Puzzles from: %s\n", options->manifestFile ? options->manifestFile
+                               : options->inputFile ? options->inputFile : "stdin");
+    if (solver.dictionary.mapping) {
+        printf("Words from: dictionary %s, %d words\n", options->dictionaryFile,
+               solver.dictionary.words.count);
+    }
+    printf("Search engine: %s\n", SEARCH_ENGINE_NAMES[searchOptions->engine]);
+    printf("Threads per process: %d (%s schedule)\n", searchOptions->threads,
+           SCHEDULE_NAMES[searchOptions->schedule]);
+    printf("Row distribution: %s\n", DISTRIBUTION_NAMES[searchOptions->distribution]);
+    if (options->groupSize > 0) {
+        printf("Process groups: %d processes each\n", options->groupSize);
+    } else {
+        printf("Process groups: chosen per window of up to %d puzzles from their dimensions\n",
+               windowSize);
+    }
+    if (options->outputFile) {
+        printf("Grid export: skipped in batch mode\n");
+    }
+
+    long totalFound = 0;
+    int number = 0;
+    for (;;) {
+        // Read ahead a window; a binary grid gets its own letters, since
+        // reading on may close the file it points into
+        BatchWindow window = {0, 1};
+        while (window.count < windowSize) {
+            BatchPuzzle* puzzle = &solver.puzzles[window.count];
+            puzzle->grid = PuzzleBatch_next(&batch, solver.windowArena, &puzzle->words);
+            if (!puzzle->grid) break;
+            useDictionaryWords(&solver.dictionary, &puzzle->words);
+
+            puzzle->name = batch.fromManifest ? copyName(solver.windowArena, batch.name) : NULL;
+            if (!Grid_ownLetters(puzzle->grid) || (batch.fromManifest && !puzzle->name)) {
+                fprintf(stderr, "Error: Failed to allocate memory for the batch\n");
+                MPI_Abort(MPI_COMM_WORLD, 1);
+                return;
+            }
+            shapes[window.count++] = describePuzzle(puzzle->grid, &puzzle->words);
+        }
+
+        if (window.count > 0 && options->groupSize > 0) {
+            window.numGroups = size / options->groupSize > 0 ? size / options->groupSize : 1;
+            assignPuzzles(shapes, window.count, size, window.numGroups, solver.assignment);
+        } else if (window.count > 0) {
+            window.numGroups = choosePuzzleGroups(shapes, window.count, size, solver.assignment);
+            printGroupChoice(window.count, size, window.numGroups);
+        }
+
+        MPI_Bcast(&window, sizeof(BatchWindow), MPI_BYTE, 0, MPI_COMM_WORLD);
+        if (window.count == 0) break;
+        MPI_Bcast(solver.assignment, window.count, MPI_INT, 0, MPI_COMM_WORLD);
+        debugPrint("DEBUG Batch: %d puzzles over %d groups\n", window.count, window.numGroups);
+
+        joinBatchGroup(&solver, rank, size, window.numGroups);
+        solveBatchWindow(&solver, rank, size, window.count);
+
+        for (int p = 0; p < window.count; p++) {
+            BatchPuzzle* puzzle = &solver.puzzles[p];
+            WordPosition* positions = hitsToPositions(puzzle->grid, &puzzle->words,
+                                                      puzzle->hits, puzzle->found);
+
+            printf("\nPuzzle %d", ++number);
+            if (puzzle->name) printf(" (%s)", puzzle->name);
+            printf(": %d columns x %d rows, %d words, %d found in %.4f seconds\n",
+                   puzzle->grid->cols, puzzle->grid->rows, puzzle->words.count, puzzle->found,
+                   puzzle->seconds);
+            for (int i = 0; i < puzzle->found; i++) {
+                printFoundWord(&positions[i]);
+            }
+
+            totalFound += puzzle->found;
+            free(positions);
+        }
+        fflush(stdout);
+        releaseBatchWindow(&solver, window.count);
+    }
+
+    printBatchMetrics(number, totalFound, startTime, MPI_Wtime(), size);
+
+    free(shapes);
+    PuzzleBatch_close(&batch);
+    destroyBatchSolver(&solver);
+}
+
+void handleWorkerBatch(int rank, int size, const OutputOptions* options,
+                       const SearchOptions* searchOptions) {
+    BatchSolver solver;
+    createBatchSolver(rank, size, options, searchOptions, &solver);
+
+    for (;;) {
+        BatchWindow window;
+        MPI_Bcast(&window, sizeof(BatchWindow), MPI_BYTE, 0, MPI_COMM_WORLD);
+        if (window.count == 0) break;
+        MPI_Bcast(solver.assignment, window.count, MPI_INT, 0, MPI_COMM_WORLD);
+
+        joinBatchGroup(&solver, rank, size, window.numGroups);
+        solveBatchWindow(&solver, rank, size, window.count);
+        releaseBatchWindow(&solver, window.count);
+    }
+
+    destroyBatchSolver(&solver);
 }
 
 RowRange calculateWorkDistribution(int rank, int size, int totalRows) {
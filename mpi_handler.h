@@ -5,10 +5,18 @@
 #include "grid.h"
 #include <mpi.h>
 
-void broadcastGridData(Grid* grid, int numWords, char words[][MAX_WORD_LENGTH]);
+void broadcastGridData(MPI_Comm comm, Grid* grid, const WordList* words, bool includeGrid);
+bool receiveGridData(MPI_Comm comm, Grid** grid, int* rows, int* cols, Arena* arena,
+                     WordList* words);
 RowRange calculateWorkDistribution(int rank, int size, int totalRows);
-void handleMasterProcess(int rank, int size, OutputOptions* options);
-void handleWorkerProcess(int rank, int size);
-void syncHighlightedArrays(Grid* grid, ProcessResults* allResults, int size);
+void handleMasterProcess(int rank, int size, OutputOptions* options,
+                        const SearchOptions* searchOptions);
+void handleWorkerProcess(int rank, int size, const OutputOptions* options,
+                         const SearchOptions* searchOptions);
+void handleMasterBatch(int rank, int size, OutputOptions* options,
+                       const SearchOptions* searchOptions);
+void handleWorkerBatch(int rank, int size, const OutputOptions* options,
+                       const SearchOptions* searchOptions);
+void syncHighlightedArrays(Grid* grid, const WordPosition* positions, int count);
 
 #endif // MPI_HANDLER_H
@@ -1,8 +1,9 @@
 #include "output.h"
+#include "work_plan.h"
 #include "debug.h"
 #include <stdio.h>
 
-void printResults(Grid* grid, ProcessResults* allResults, int size,
+void printResults(Grid* grid, const WordPosition* positions, int count, int size,
                  double startTime, double endTime) {
     printf("\nSearch Results:\n");
     printf("--------------\n");
@@ -10,15 +11,11 @@ void printResults(Grid* grid, ProcessResults* allResults, int size,
     Grid_print(grid);
 
     printf("\nFound Words:\n");
-    int totalFound = 0;
-    for (int i = 0; i < size; i++) {
-        for (int j = 0; j < allResults[i].validResults; j++) {
-            printFoundWord(&allResults[i].positions[j]);
-            totalFound++;
-        }
+    for (int i = 0; i < count; i++) {
+        printFoundWord(&positions[i]);
     }
 
-    printPerformanceMetrics(totalFound, startTime, endTime, size);
+    printPerformanceMetrics(count, startTime, endTime, size);
 }
 
 void printFoundWord(const WordPosition* pos) {
@@ -39,3 +36,111 @@ void printPerformanceMetrics(int totalFound, double startTime, double endTime,
     printf("Processing speed: %.2f words/second\n", wordsPerSecond);
     printf("Number of processes: %d\n", numProcesses);
 }
+
+void printBatchMetrics(int puzzles, long totalFound, double startTime, double endTime,
+                       int numProcesses) {
+    double totalTime = endTime - startTime;
+
+    printf("\nBatch Metrics:\n");
+    printf("-------------\n");
+    printf("Puzzles solved: %d\n", puzzles);
+    printf("Total words found: %ld\n", totalFound);
+    printf("Execution time: %.4f seconds\n", totalTime);
+    printf("Throughput: %.2f puzzles/second\n", totalTime > 0 ? puzzles / totalTime : 0.0);
+    printf("Number of processes: %d\n", numProcesses);
+}
+
+// Groups chosen for one batch window; group sizes differ by at most one
+void printGroupChoice(int puzzles, int numProcesses, int numGroups) {
+    int smallest = numProcesses / numGroups;
+    int largest = smallest + (numProcesses % numGroups ? 1 : 0);
+
+    printf("\nProcess groups for the next %d puzzles: %d of ", puzzles, numGroups);
+    if (smallest == largest) {
+        printf("%d processes\n", smallest);
+    } else {
+        printf("%d to %d processes\n", smallest, largest);
+    }
+}
+
+void printChunkStats(const ChunkStats* stats, int numProcesses) {
+    printf("\nDynamic Distribution:\n");
+    printf("---------------------\n");
+    for (int proc = 0; proc < numProcesses; proc++) {
+        printf("Process %d: %d rows in %d chunks\n",
+               proc, stats[proc].rows, stats[proc].chunks);
+    }
+}
+
+void printTileStats(const TileStats* stats, int numProcesses, long gridCells) {
+    printf("\nTile Decomposition:\n");
+    printf("--------------------\n");
+    for (int proc = 0; proc < numProcesses; proc++) {
+        const TileStats* tile = &stats[proc];
+        printf("Process %d: rows %d-%d, cols %d-%d, ghost border %d, %ld of %ld cells held\n",
+               proc, tile->rows.start, tile->rows.end - 1, tile->cols.start,
+               tile->cols.end - 1, tile->halo, tile->cells, gridCells);
+    }
+}
+
+void printWorkPlans(const WorkPlan* plans, int numPlans, const WorkPlan* chosen) {
+    printf("\nWork Plan:\n");
+    printf("----------\n");
+    for (int i = 0; i < numPlans; i++) {
+        bool isChosen = plans[i].rowParts == chosen->rowParts &&
+                        plans[i].wordParts == chosen->wordParts;
+        printf("%s %d row x %d word parts: predicted %.6f seconds\n",
+               isChosen ? "*" : " ", plans[i].rowParts, plans[i].wordParts,
+               plans[i].predicted);
+    }
+    printf("Strategy: %s, predicted %.6f seconds, actual %.6f seconds\n",
+           workPlanName(chosen), chosen->predicted, chosen->actual);
+}
+
+void printWorkerStats(const WorkerStats* stats, int numProcesses, int threads) {
+    printf("\nWorker Balance:\n");
+    printf("---------------\n");
+    for (int proc = 0; proc < numProcesses; proc++) {
+        for (int t = 0; t < threads; t++) {
+            const WorkerStats* worker = &stats[proc * threads + t];
+            printf("Process %d thread %d: busy %.4f s, idle %.4f s, %d tasks (%d stolen)\n",
+                   proc, t, worker->busy, worker->idle, worker->tasks, worker->steals);
+        }
+    }
+}
+
+void printAnchorStats(long candidates, long firstLetterCandidates) {
+    printf("\nAnchor Candidates:\n");
+    printf("------------------\n");
+    printf("Rarest letter: %ld start positions tried\n", candidates);
+    printf("First letter: %ld start positions (%.1fx as many)\n", firstLetterCandidates,
+           candidates > 0 ? (double)firstLetterCandidates / candidates : 0.0);
+}
+
+void printPrefilterStats(int rejectedWords, int totalWords) {
+    printf("\nPrefilter:\n");
+    printf("----------\n");
+    printf("Ruled out: %d of %d words (letters, pairs or triples not in the grid)\n",
+           rejectedWords, totalWords);
+    printf("Searched: %d words\n", totalWords - rejectedWords);
+}
+
+// How much of a full scan the index saved, against what it cost to get
+void printIndexMetrics(const GridIndex* index, const char* path, double indexSeconds,
+                       double searchSeconds, long candidates, long positions) {
+    printf("\nGrid Index:\n");
+    printf("-----------\n");
+    if (index->mapping) {
+        printf("Loaded from %s in %.4f seconds\n", path, indexSeconds);
+    } else {
+        printf("Built in %.4f seconds%s%s\n", indexSeconds, path ? ", saved to " : "",
+               path ? path : "");
+    }
+    printf("Buckets: %d of %d-letter grams, %ld start positions\n",
+           1 << index->bucketBits, GRID_INDEX_K,
+           (long)index->rows * index->cols * DIRECTIONS_COUNT);
+    printf("Verified: %ld of %ld word start positions (%.1fx fewer than a full scan)\n",
+           candidates, positions, candidates > 0 ? (double)positions / candidates : 0.0);
+    printf("Search: %.4f seconds, after %.4f seconds getting the index\n", searchSeconds,
+           indexSeconds);
+}
@@ -3,11 +3,23 @@
 
 #include "types.h"
 #include "grid.h"
+#include "grid_index.h"
 
-void printResults(Grid* grid, ProcessResults* allResults, int size,
+void printResults(Grid* grid, const WordPosition* positions, int count, int size,
                  double startTime, double endTime);
 void printFoundWord(const WordPosition* pos);
 void printPerformanceMetrics(int totalFound, double startTime, double endTime,
                            int numProcesses);
+void printGroupChoice(int puzzles, int numProcesses, int numGroups);
+void printBatchMetrics(int puzzles, long totalFound, double startTime, double endTime,
+                       int numProcesses);
+void printChunkStats(const ChunkStats* stats, int numProcesses);
+void printTileStats(const TileStats* stats, int numProcesses, long gridCells);
+void printWorkPlans(const WorkPlan* plans, int numPlans, const WorkPlan* chosen);
+void printWorkerStats(const WorkerStats* stats, int numProcesses, int threads);
+void printAnchorStats(long candidates, long firstLetterCandidates);
+void printPrefilterStats(int rejectedWords, int totalWords);
+void printIndexMetrics(const GridIndex* index, const char* path, double indexSeconds,
+                       double searchSeconds, long candidates, long positions);
 
 #endif // OUTPUT_H
@@ -0,0 +1,127 @@
+#include "puzzle_file.h"
+#include "word_list.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <limits.h>
+
+static bool isValidHeader(const BinaryPuzzleHeader* header, MPI_Offset size) {
+    uint64_t gridBytes = (uint64_t)header->rows * header->cols;
+    return memcmp(header->magic, BINARY_PUZZLE_MAGIC, 4) == 0 &&
+           header->version == BINARY_PUZZLE_VERSION &&
+           header->rows <= INT_MAX && header->cols <= INT_MAX &&
+           header->wordCount <= INT_MAX && header->wordBytes <= INT_MAX &&
+           header->gridOffset <= (uint64_t)size && gridBytes <= (uint64_t)size - header->gridOffset &&
+           header->wordsOffset <= (uint64_t)size &&
+           header->wordBytes <= (uint64_t)size - header->wordsOffset;
+}
+
+// Opens path and reads its header; words may be NULL on a process that
+// already holds them
+bool PuzzleFile_open(const char* path, Arena* arena, WordList* words, PuzzleFile* file) {
+    memset(file, 0, sizeof(PuzzleFile));
+    file->row = MPI_DATATYPE_NULL;
+
+    if (MPI_File_open(MPI_COMM_WORLD, path, MPI_MODE_RDONLY, MPI_INFO_NULL,
+                      &file->file) != MPI_SUCCESS) {
+        return false;
+    }
+
+    // Every process reads the same header, so all of them agree on whether it is usable
+    MPI_Offset size = 0;
+    MPI_File_get_size(file->file, &size);
+    if (size < (MPI_Offset)sizeof(BinaryPuzzleHeader) ||
+        MPI_File_read_at_all(file->file, 0, &file->header, sizeof(BinaryPuzzleHeader),
+                             MPI_BYTE, MPI_STATUS_IGNORE) != MPI_SUCCESS ||
+        !isValidHeader(&file->header, size)) {
+        MPI_File_close(&file->file);
+        return false;
+    }
+    file->rows = file->header.rows;
+    file->cols = file->header.cols;
+
+    int tableBytes = words ? (int)file->header.wordBytes : 0;
+    char* table = (char*)malloc(tableBytes > 0 ? tableBytes : 1);
+    bool read = MPI_File_read_at_all(file->file, file->header.wordsOffset, table,
+                                     table ? tableBytes : 0, MPI_BYTE,
+                                     MPI_STATUS_IGNORE) == MPI_SUCCESS && table;
+    if (read && words) {
+        read = WordList_unpack(words, arena, file->header.wordCount, table, tableBytes);
+    }
+    free(table);
+
+    MPI_Type_contiguous(file->cols, MPI_CHAR, &file->row);
+    MPI_Type_commit(&file->row);
+    if (!read) {
+        PuzzleFile_close(file);
+        return false;
+    }
+    return true;
+}
+
+// Reads the grid rows of a rows x cols tile plus halo rows on each side,
+// wrapping around the torus, and builds the tile's padded search layout
+// from them. Rows are read whole, two collective reads at most: the run
+// up to the bottom of the grid and the part that wraps to the top.
+Grid* PuzzleFile_readTile(PuzzleFile* file, RowRange rows, RowRange cols, int halo) {
+    int gridRows = file->rows;
+    int gridCols = file->cols;
+    int tileRows = rows.end - rows.start;
+    int tileCols = cols.end - cols.start;
+    if (halo < 0) halo = 0;
+
+    int needed = tileRows > 0 && gridCols > 0 ? tileRows + 2 * halo : 0;
+    if (needed > gridRows) needed = gridRows;
+    int first = needed > 0 ? ((rows.start - halo) % gridRows + gridRows) % gridRows : 0;
+    int head = needed < gridRows - first ? needed : gridRows - first;
+
+    char* band = (char*)malloc(needed > 0 ? (size_t)needed * gridCols : 1);
+    Grid* tile = Grid_create(tileRows, tileCols);
+    int headRows = band ? head : 0;
+    int tailRows = band ? needed - head : 0;
+
+    MPI_Offset start = file->header.gridOffset + (MPI_Offset)first * gridCols;
+    bool read = MPI_File_read_at_all(file->file, start, band, headRows, file->row,
+                                     MPI_STATUS_IGNORE) == MPI_SUCCESS;
+    read = MPI_File_read_at_all(file->file, file->header.gridOffset,
+                                band ? band + (size_t)headRows * gridCols : NULL, tailRows,
+                                file->row, MPI_STATUS_IGNORE) == MPI_SUCCESS && read;
+
+    int stride = tileCols + 2 * halo;
+    int paddedRows = tileRows + 2 * halo;
+    char* cells = needed > 0 ? (char*)malloc((size_t)stride * paddedRows) : NULL;
+    if (!band || !tile || !read || (needed > 0 && !cells)) {
+        free(band);
+        free(cells);
+        Grid_destroy(tile);
+        return NULL;
+    }
+
+    for (int r = 0; r < paddedRows && needed > 0; r++) {
+        int gridRow = rows.start - halo + r;
+        const char* source = band + (size_t)(((gridRow - first) % gridRows + gridRows) % gridRows) * gridCols;
+        char* target = cells + (size_t)r * stride;
+
+        for (int c = 0; c < stride; c++) {
+            target[c] = (char)tolower((unsigned char)source[((cols.start - halo + c) % gridCols + gridCols) % gridCols]);
+        }
+        if (r >= halo && r < halo + tileRows) {
+            memcpy(tile->letters[r - halo], source + cols.start, tileCols);
+        }
+    }
+
+    tile->cells = cells;
+    tile->stride = stride;
+    tile->halo = halo;
+    free(band);
+
+    debugPrint("DEBUG File: read %d grid rows for a %d x %d tile\n", needed, tileRows, tileCols);
+    return tile;
+}
+
+void PuzzleFile_close(PuzzleFile* file) {
+    if (file->row != MPI_DATATYPE_NULL) MPI_Type_free(&file->row);
+    MPI_File_close(&file->file);
+}
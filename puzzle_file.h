@@ -0,0 +1,24 @@
+#ifndef PUZZLE_FILE_H
+#define PUZZLE_FILE_H
+
+#include "types.h"
+#include "grid.h"
+#include "binary_puzzle.h"
+#include <mpi.h>
+
+// A binary puzzle opened by every process with MPI-IO, so each one reads
+// the rows it searches straight from the file. All calls are collective
+// over MPI_COMM_WORLD.
+typedef struct {
+    MPI_File file;
+    BinaryPuzzleHeader header;
+    int rows;
+    int cols;
+    MPI_Datatype row;       // One grid row, cols bytes
+} PuzzleFile;
+
+bool PuzzleFile_open(const char* path, Arena* arena, WordList* words, PuzzleFile* file);
+Grid* PuzzleFile_readTile(PuzzleFile* file, RowRange rows, RowRange cols, int halo);
+void PuzzleFile_close(PuzzleFile* file);
+
+#endif // PUZZLE_FILE_H
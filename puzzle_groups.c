@@ -0,0 +1,134 @@
+#include "puzzle_groups.h"
+#include "work_plan.h"
+#include "word_list.h"
+#include "debug.h"
+#include <stdlib.h>
+#include <math.h>
+
+// Cost model weights, in cell visits. Every process of a group folds the
+// whole grid into its search layout, and each level of the group's
+// broadcast and gather trees pays a fixed latency plus the grid bytes it
+// forwards.
+#define GROUP_LAYOUT_UNITS 2.0
+#define GROUP_STEP_UNITS 20000.0
+#define GROUP_BYTE_UNITS 1.0
+
+typedef struct {
+    double units;
+    int index;
+} PuzzleOrder;
+
+PuzzleShape describePuzzle(const Grid* grid, const WordList* words) {
+    PuzzleShape shape = {grid->rows, grid->cols, words->count, 0};
+    for (int i = 0; i < words->count; i++) {
+        shape.totalLength += WordList_length(words, i);
+    }
+    return shape;
+}
+
+int groupOfProcess(int rank, int size, int numGroups) {
+    return (int)((long)rank * numGroups / size);
+}
+
+int groupLeader(int group, int size, int numGroups) {
+    return (int)(((long)group * size + numGroups - 1) / numGroups);
+}
+
+int groupSize(int group, int size, int numGroups) {
+    return groupLeader(group + 1, size, numGroups) - groupLeader(group, size, numGroups);
+}
+
+// Predicted cell visits for a group of processes to solve a puzzle: the
+// busiest row band and the layout, plus the collectives that move the
+// puzzle and its hits
+static double groupUnits(const PuzzleShape* puzzle, int processes) {
+    double cells = (double)puzzle->rows * puzzle->cols;
+    double units = workPlanUnits(puzzle->rows, puzzle->cols, puzzle->numWords,
+                                 puzzle->totalLength, processes, 1) +
+                   cells * GROUP_LAYOUT_UNITS;
+    if (processes > 1) {
+        units += ceil(log2(processes)) * (GROUP_STEP_UNITS + cells * GROUP_BYTE_UNITS);
+    }
+    return units;
+}
+
+static int compareByUnits(const void* a, const void* b) {
+    const PuzzleOrder* left = (const PuzzleOrder*)a;
+    const PuzzleOrder* right = (const PuzzleOrder*)b;
+    if (left->units != right->units) return left->units > right->units ? -1 : 1;
+    return left->index - right->index;
+}
+
+// Longest processing time first: the largest puzzles are placed first, each
+// on the group that would finish it soonest. Returns the predicted time
+// until the last group finishes, in cell visits.
+double assignPuzzles(const PuzzleShape* puzzles, int count, int size, int numGroups,
+                     int* assignment) {
+    PuzzleOrder* order = (PuzzleOrder*)malloc((count > 0 ? count : 1) * sizeof(PuzzleOrder));
+    double* load = (double*)calloc(numGroups, sizeof(double));
+    if (!order || !load) {
+        for (int p = 0; p < count; p++) {
+            assignment[p] = p % numGroups;
+        }
+        free(order);
+        free(load);
+        return HUGE_VAL;
+    }
+
+    for (int p = 0; p < count; p++) {
+        order[p] = (PuzzleOrder){groupUnits(&puzzles[p], 1), p};
+    }
+    qsort(order, count, sizeof(PuzzleOrder), compareByUnits);
+
+    double makespan = 0.0;
+    for (int i = 0; i < count; i++) {
+        const PuzzleShape* puzzle = &puzzles[order[i].index];
+        int best = 0;
+        double bestFinish = HUGE_VAL;
+        for (int g = 0; g < numGroups; g++) {
+            double finish = load[g] + groupUnits(puzzle, groupSize(g, size, numGroups));
+            if (finish < bestFinish) {
+                best = g;
+                bestFinish = finish;
+            }
+        }
+
+        assignment[order[i].index] = best;
+        load[best] = bestFinish;
+        if (bestFinish > makespan) makespan = bestFinish;
+    }
+
+    free(order);
+    free(load);
+    return makespan;
+}
+
+// Tries every group count from one group per process down to a single
+// group of all processes and keeps the assignment predicted to finish
+// first; ties go to more, smaller groups. Returns the group count.
+int choosePuzzleGroups(const PuzzleShape* puzzles, int count, int size, int* assignment) {
+    int* trial = (int*)malloc((count > 0 ? count : 1) * sizeof(int));
+    int maxGroups = count < size ? count : size;
+    if (maxGroups < 1) maxGroups = 1;
+    if (!trial) {
+        assignPuzzles(puzzles, count, size, 1, assignment);
+        return 1;
+    }
+
+    int bestGroups = 0;
+    double bestUnits = HUGE_VAL;
+    for (int numGroups = maxGroups; numGroups >= 1; numGroups--) {
+        double units = assignPuzzles(puzzles, count, size, numGroups, trial);
+        debugPrint("DEBUG Groups: %d groups, predicted %.0f units\n", numGroups, units);
+        if (bestGroups == 0 || units < bestUnits) {
+            bestGroups = numGroups;
+            bestUnits = units;
+            for (int p = 0; p < count; p++) {
+                assignment[p] = trial[p];
+            }
+        }
+    }
+
+    free(trial);
+    return bestGroups;
+}
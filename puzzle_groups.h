@@ -0,0 +1,28 @@
+#ifndef PUZZLE_GROUPS_H
+#define PUZZLE_GROUPS_H
+
+#include "types.h"
+
+#define TAG_BATCH_PUZZLE 106
+#define TAG_BATCH_RESULT 107
+
+// What the batch cost model needs to know of a puzzle
+typedef struct {
+    int rows;
+    int cols;
+    int numWords;
+    long totalLength;       // Letters over all words
+} PuzzleShape;
+
+PuzzleShape describePuzzle(const Grid* grid, const WordList* words);
+
+// Processes are split into numGroups consecutive blocks of near equal size
+int groupOfProcess(int rank, int size, int numGroups);
+int groupLeader(int group, int size, int numGroups);
+int groupSize(int group, int size, int numGroups);
+
+double assignPuzzles(const PuzzleShape* puzzles, int count, int size, int numGroups,
+                     int* assignment);
+int choosePuzzleGroups(const PuzzleShape* puzzles, int count, int size, int* assignment);
+
+#endif // PUZZLE_GROUPS_H
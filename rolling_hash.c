@@ -0,0 +1,215 @@
+#include "rolling_hash.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Odd base of the polynomial hash; arithmetic wraps modulo 2^64
+#define HASH_BASE 0x100000001b3ull
+
+static inline uint64_t hashLetters(const char* letters, int step, int len) {
+    uint64_t hash = 0;
+    for (int i = 0; i < len; i++, letters += step) {
+        hash = hash * HASH_BASE + (unsigned char)*letters;
+    }
+    return hash;
+}
+
+static inline int slotOf(const LengthGroup* group, uint64_t hash) {
+    return (int)((hash * 0x9E3779B97F4A7C15ull) >> 32) & group->mask;
+}
+
+// First word of the group with this hash, or -1. Tables are at most half
+// full, so the probe always reaches an empty slot.
+static inline int findWords(const LengthGroup* group, uint64_t hash) {
+    for (int slot = slotOf(group, hash);; slot = (slot + 1) & group->mask) {
+        if (group->firstWord[slot] < 0) return -1;
+        if (group->keys[slot] == hash) return group->firstWord[slot];
+    }
+}
+
+static bool createGroup(LengthGroup* group, int length, int count) {
+    int slots = 2;
+    while (slots < 2 * count) slots *= 2;
+
+    group->length = length;
+    group->power = 1;
+    for (int i = 1; i < length; i++) {
+        group->power *= HASH_BASE;
+    }
+    group->mask = slots - 1;
+    group->keys = (uint64_t*)calloc(slots, sizeof(uint64_t));
+    group->firstWord = (int*)malloc(slots * sizeof(int));
+    if (!group->keys || !group->firstWord) return false;
+
+    for (int s = 0; s < slots; s++) {
+        group->firstWord[s] = -1;
+    }
+    return true;
+}
+
+WordHashes* WordHashes_create(const WordList* words) {
+    WordHashes* hashes = (WordHashes*)calloc(1, sizeof(WordHashes));
+    int* counts = (int*)calloc(words->longest + 1, sizeof(int));
+    int* groupOf = (int*)malloc((words->longest + 1) * sizeof(int));
+    if (!hashes || !counts || !groupOf) {
+        free(hashes);
+        free(counts);
+        free(groupOf);
+        return NULL;
+    }
+
+    for (int w = 0; w < words->count; w++) {
+        counts[WordList_length(words, w)]++;
+    }
+    for (int len = 1; len <= words->longest; len++) {
+        if (counts[len] > 0) hashes->groupCount++;
+    }
+
+    hashes->groups = (LengthGroup*)calloc(hashes->groupCount > 0 ? hashes->groupCount : 1,
+                                          sizeof(LengthGroup));
+    hashes->nextWord = (int*)malloc((words->count > 0 ? words->count : 1) * sizeof(int));
+    bool ok = hashes->groups && hashes->nextWord;
+
+    for (int len = 1, g = 0; len <= words->longest && ok; len++) {
+        if (counts[len] == 0) continue;
+        groupOf[len] = g;
+        ok = createGroup(&hashes->groups[g++], len, counts[len]);
+    }
+
+    // Insert in reverse so each chain lists its words in input order
+    for (int w = words->count - 1; w >= 0 && ok; w--) {
+        int len = WordList_length(words, w);
+        hashes->nextWord[w] = -1;
+        if (len == 0) continue;
+
+        LengthGroup* group = &hashes->groups[groupOf[len]];
+        uint64_t hash = hashLetters(WordList_folded(words, w), 1, len);
+        int slot = slotOf(group, hash);
+        while (group->firstWord[slot] >= 0 && group->keys[slot] != hash) {
+            slot = (slot + 1) & group->mask;
+        }
+        hashes->nextWord[w] = group->firstWord[slot];
+        group->keys[slot] = hash;
+        group->firstWord[slot] = w;
+    }
+
+    free(counts);
+    free(groupOf);
+    if (!ok) {
+        WordHashes_destroy(hashes);
+        return NULL;
+    }
+
+    debugPrint("DEBUG Rolling: %d words in %d lengths\n", words->count, hashes->groupCount);
+    return hashes;
+}
+
+void WordHashes_destroy(WordHashes* hashes) {
+    if (!hashes) return;
+
+    if (hashes->groups) {
+        for (int g = 0; g < hashes->groupCount; g++) {
+            free(hashes->groups[g].keys);
+            free(hashes->groups[g].firstWord);
+        }
+    }
+    free(hashes->groups);
+    free(hashes->nextWord);
+    free(hashes);
+}
+
+static inline bool inBand(int row, int col, RowRange range, int cols) {
+    return row >= range.start && row < range.end && col >= 0 && col < cols;
+}
+
+// Rolls the hash of length-letter windows along every segment of start
+// cells in direction dir that lies inside the band, looking each one up
+// among the words of that length
+static bool rollDirection(const Grid* grid, const WordList* words, const WordHashes* hashes,
+                          const LengthGroup* group, Direction dir, RowRange range,
+                          SearchHit** hits, int* numHits, int* capacity) {
+    DirectionVector vector = DIRECTION_VECTORS[dir];
+    int step = Grid_stepOffset(grid, vector.dx, vector.dy);
+    int len = group->length;
+
+    for (int i = range.start; i < range.end; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            // Walk each segment once, from the cell whose predecessor
+            // along dir falls outside the band
+            if (inBand(i - vector.dx, j - vector.dy, range, grid->cols)) continue;
+
+            const char* cell = Grid_cellPtr(grid, i, j);
+            uint64_t hash = hashLetters(cell, step, len);
+            for (int row = i, col = j;;) {
+                for (int w = findWords(group, hash); w >= 0; w = hashes->nextWord[w]) {
+                    if (matchesFoldedWord(cell, step, WordList_folded(words, w), len) &&
+                        !pushSearchHit(hits, numHits, capacity, (SearchHit){w, row, col, dir})) {
+                        return false;
+                    }
+                }
+
+                row += vector.dx;
+                col += vector.dy;
+                if (!inBand(row, col, range, grid->cols)) break;
+
+                // Drop the first letter of the window and take the next one
+                hash = (hash - (unsigned char)cell[0] * group->power) * HASH_BASE +
+                       (unsigned char)cell[(size_t)len * step];
+                cell += step;
+            }
+        }
+    }
+    return true;
+}
+
+// Rolls every direction line of range against hashes built beforehand,
+// so the row blocks of one search can share them. Needs the padded layout
+// with a halo of at least words->longest - 1.
+void searchHashRows(Grid* grid, const WordHashes* hashes, const WordList* words,
+                    RowRange range, ProcessResults* results) {
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    bool ok = hits != NULL;
+
+    for (Direction dir = 0; dir < DIRECTIONS_COUNT && ok; dir++) {
+        for (int g = 0; g < hashes->groupCount && ok; g++) {
+            ok = rollDirection(grid, words, hashes, &hashes->groups[g], dir, range,
+                               &hits, &numHits, &hitCapacity);
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for rolling hash matches\n");
+        free(hits);
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    appendSortedHits(grid, words, hits, numHits, results);
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+    debugPrint("Rolling hash search found %d matches in rows %d to %d\n",
+               numHits, range.start, range.end - 1);
+    free(hits);
+}
+
+// Rabin-Karp over every direction line: one rolling pass per distinct
+// word length instead of one scan per word
+void searchWordsRolling(Grid* grid, const WordList* words, RowRange range,
+                        ProcessResults* results) {
+    WordHashes* hashes = WordHashes_create(words);
+    if (searchWordsFallback(grid, words, range, results,
+                            hashes && Grid_ensureSearchLayout(grid, words->longest - 1))) {
+        WordHashes_destroy(hashes);
+        return;
+    }
+
+    searchHashRows(grid, hashes, words, range, results);
+    WordHashes_destroy(hashes);
+}
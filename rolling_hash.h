@@ -0,0 +1,33 @@
+#ifndef ROLLING_HASH_H
+#define ROLLING_HASH_H
+
+#include "types.h"
+#include "grid.h"
+#include <stdint.h>
+
+// Words of one length, in an open-addressed table keyed by their
+// polynomial hash. Words with equal hashes are chained through nextWord.
+typedef struct {
+    int length;
+    uint64_t power;         // Hash base to the power length - 1
+    uint64_t* keys;         // Hash in each slot
+    int* firstWord;         // First word with the slot's hash, -1 when empty
+    int mask;               // Slot count - 1
+} LengthGroup;
+
+// The word list grouped by length, one group per distinct length in
+// increasing order
+typedef struct {
+    LengthGroup* groups;
+    int groupCount;
+    int* nextWord;          // Next word with the same length and hash, -1 if none
+} WordHashes;
+
+WordHashes* WordHashes_create(const WordList* words);
+void WordHashes_destroy(WordHashes* hashes);
+void searchHashRows(Grid* grid, const WordHashes* hashes, const WordList* words,
+                    RowRange range, ProcessResults* results);
+void searchWordsRolling(Grid* grid, const WordList* words, RowRange range,
+                        ProcessResults* results);
+
+#endif // ROLLING_HASH_H
@@ -0,0 +1,324 @@
+#include "scheduler.h"
+#include "search.h"
+#include "word_list.h"
+#include "trie.h"
+#include "bitplane.h"
+#include "rolling_hash.h"
+#include "anchor.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <time.h>
+
+// Row blocks per thread for every word; more blocks balance better but
+// cost more per-task overhead
+#define BLOCKS_PER_THREAD 4
+
+typedef struct {
+    double cost;
+    int task;
+} TaskOrder;
+
+// State of a whole-list engine, built once over the process's rows before
+// the deques are filled and only read by the tasks
+typedef struct {
+    const Trie* trie;
+    Trie* ownedTrie;        // Built here when the words came without one
+    LetterPlanes* planes;
+    WordHashes* hashes;
+    LetterPositions* positions;
+} EngineState;
+
+typedef struct {
+    Grid* grid;
+    const WordList* words;
+    SearchEngine engine;
+    EngineState state;
+    SearchTask* tasks;
+    TaskDeque* deques;
+    ProcessResults* buffers;    // Per thread, in the thread's scratch arena
+    WorkerStats* stats;
+    int threads;
+} StealingSearch;
+
+static double monotonicSeconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static bool TaskDeque_popFront(TaskDeque* deque, int* task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->head < deque->tail;
+    if (found) *task = deque->items[deque->head++];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static bool TaskDeque_popBack(TaskDeque* deque, int* task) {
+    pthread_mutex_lock(&deque->lock);
+    bool found = deque->head < deque->tail;
+    if (found) *task = deque->items[--deque->tail];
+    pthread_mutex_unlock(&deque->lock);
+    return found;
+}
+
+static int compareTaskCost(const void* a, const void* b) {
+    const TaskOrder* x = (const TaskOrder*)a;
+    const TaskOrder* y = (const TaskOrder*)b;
+
+    // Descending cost; ties keep result order
+    if (x->cost != y->cost) return x->cost < y->cost ? 1 : -1;
+    return x->task - y->task;
+}
+
+// Expected work of a task: every cell is scanned once, and cells holding the
+// first letter cost up to 8 directions times the word length
+static double estimateCost(const int* letterCounts, int totalCells, const char* word,
+                           RowRange rows, int cols) {
+    int len = strlen(word);
+    double firstShare = totalCells > 0
+        ? (double)letterCounts[(unsigned char)tolower((unsigned char)word[0])] / totalCells : 0.0;
+    return (double)(rows.end - rows.start) * cols * (1.0 + DIRECTIONS_COUNT * firstShare * len);
+}
+
+// Engines that match every word in one pass over their rows; a task of
+// theirs is a row block over the whole list, since a one-word slice would
+// redo the pass per word
+static bool searchesWholeList(SearchEngine engine) {
+    return engine == ENGINE_TRIE || engine == ENGINE_LINES || engine == ENGINE_BITPLANE ||
+           engine == ENGINE_ROLLING || engine == ENGINE_ANCHOR;
+}
+
+static bool EngineState_build(EngineState* state, Grid* grid, const WordList* words,
+                              RowRange range, SearchEngine engine) {
+    memset(state, 0, sizeof(EngineState));
+
+    switch (engine) {
+        case ENGINE_TRIE:
+            // A compiled dictionary brings its own automaton
+            if (!words->trie) state->ownedTrie = Trie_create(words);
+            state->trie = words->trie ? words->trie : state->ownedTrie;
+            return state->trie != NULL;
+        case ENGINE_BITPLANE:
+            state->planes = LetterPlanes_create(grid, words, range);
+            return state->planes != NULL;
+        case ENGINE_ROLLING:
+            state->hashes = WordHashes_create(words);
+            return state->hashes != NULL;
+        case ENGINE_ANCHOR:
+            state->positions = LetterPositions_create(grid, range);
+            return state->positions != NULL;
+        default:
+            // Line families are built per block, over the block's rows only
+            return true;
+    }
+}
+
+static void EngineState_release(EngineState* state) {
+    Trie_destroy(state->ownedTrie);
+    LetterPlanes_destroy(state->planes);
+    WordHashes_destroy(state->hashes);
+    LetterPositions_destroy(state->positions);
+}
+
+static void searchBlock(StealingSearch* search, RowRange rows, ProcessResults* buffer) {
+    switch (search->engine) {
+        case ENGINE_TRIE:
+            searchTrieRows(search->grid, search->state.trie, search->words, rows, buffer);
+            break;
+        case ENGINE_BITPLANE:
+            searchPlaneRows(search->grid, search->state.planes, search->words, rows, buffer);
+            break;
+        case ENGINE_ROLLING:
+            searchHashRows(search->grid, search->state.hashes, search->words, rows, buffer);
+            break;
+        case ENGINE_ANCHOR:
+            searchAnchorRows(search->grid, search->state.positions, search->words, rows, buffer);
+            break;
+        default:
+            searchWordsWithEngine(search->grid, search->words, rows, search->engine, buffer);
+            break;
+    }
+}
+
+static void runTask(StealingSearch* search, int thread, int index) {
+    SearchTask* task = &search->tasks[index];
+    ProcessResults* buffer = &search->buffers[thread];
+
+    task->thread = thread;
+    task->offset = buffer->validResults;
+    if (task->word == ALL_WORDS) {
+        searchBlock(search, task->rows, buffer);
+        task->count = buffer->validResults - task->offset;
+        return;
+    }
+
+    WordList word = WordList_slice(search->words, task->word, 1);
+    searchWordsWithEngine(search->grid, &word, task->rows, search->engine, buffer);
+    task->count = buffer->validResults - task->offset;
+
+    for (int i = task->offset; i < buffer->validResults; i++) {
+        buffer->positions[i].wordIndex = task->word;
+    }
+}
+
+static void stealingWorker(int thread, void* context) {
+    StealingSearch* search = (StealingSearch*)context;
+    WorkerStats* stats = &search->stats[thread];
+    int index;
+
+    for (;;) {
+        bool stolen = false;
+        bool found = TaskDeque_popFront(&search->deques[thread], &index);
+
+        // Own deque is empty: take the cheapest task left on another thread
+        for (int v = 1; !found && v < search->threads; v++) {
+            found = TaskDeque_popBack(&search->deques[(thread + v) % search->threads], &index);
+            stolen = found;
+        }
+        if (!found) break;
+
+        double start = monotonicSeconds();
+        runTask(search, thread, index);
+        stats->busy += monotonicSeconds() - start;
+        stats->tasks++;
+        if (stolen) stats->steals++;
+    }
+}
+
+void searchWordsStealing(ThreadPool* pool, Grid* grid, const WordList* words,
+                         RowRange range, SearchEngine engine, WorkerStats* stats,
+                         ProcessResults* results) {
+    int numWords = words->count;
+    int threads = pool->threadCount;
+    int rangeRows = range.end - range.start;
+    memset(stats, 0, threads * sizeof(WorkerStats));
+    if (numWords > results->totalProcessed) results->totalProcessed = numWords;
+    if (numWords == 0 || rangeRows <= 0) return;
+
+    prepareSharedSearchState(grid, words);
+
+    int blockRows = (rangeRows + threads * BLOCKS_PER_THREAD - 1) / (threads * BLOCKS_PER_THREAD);
+    int blocks = (rangeRows + blockRows - 1) / blockRows;
+    bool wholeList = searchesWholeList(engine);
+    int numTasks = (wholeList ? 1 : numWords) * blocks;
+
+    StealingSearch search = {
+        .grid = grid,
+        .words = words,
+        .engine = engine,
+        .tasks = (SearchTask*)calloc(numTasks, sizeof(SearchTask)),
+        .deques = (TaskDeque*)calloc(threads, sizeof(TaskDeque)),
+        .buffers = (ProcessResults*)calloc(threads, sizeof(ProcessResults)),
+        .stats = stats,
+        .threads = threads
+    };
+    TaskOrder* order = (TaskOrder*)malloc(numTasks * sizeof(TaskOrder));
+    int perThread = (numTasks + threads - 1) / threads;
+    int* dealt = (int*)malloc((size_t)perThread * threads * sizeof(int));
+
+    bool built = EngineState_build(&search.state, grid, words, range, engine);
+
+    if (!search.tasks || !search.deques || !search.buffers || !order || !dealt || !built) {
+        fprintf(stderr, "Error: Failed to allocate memory for task scheduler\n");
+        EngineState_release(&search.state);
+        free(search.tasks);
+        free(search.deques);
+        free(search.buffers);
+        free(order);
+        free(dealt);
+        searchWordsWithEngine(grid, words, range, engine, results);
+        return;
+    }
+
+    // Letter frequencies of the grid drive the cost estimate
+    int letterCounts[256] = {0};
+    for (int i = 0; i < grid->rows; i++) {
+        for (int j = 0; j < grid->cols; j++) {
+            letterCounts[(unsigned char)tolower((unsigned char)grid->letters[i][j])]++;
+        }
+    }
+
+    // Tasks are stored in result order: word, then row block
+    for (int w = 0; w < numTasks / blocks; w++) {
+        for (int b = 0; b < blocks; b++) {
+            SearchTask* task = &search.tasks[w * blocks + b];
+            task->word = wholeList ? ALL_WORDS : w;
+            task->rows.start = range.start + b * blockRows;
+            task->rows.end = task->rows.start + blockRows < range.end
+                           ? task->rows.start + blockRows : range.end;
+            task->cost = wholeList
+                ? (double)(task->rows.end - task->rows.start) * grid->cols
+                : estimateCost(letterCounts, grid->rows * grid->cols,
+                               WordList_folded(words, w), task->rows, grid->cols);
+            order[w * blocks + b] = (TaskOrder){task->cost, w * blocks + b};
+        }
+    }
+
+    // Longest expected cost first, dealt round-robin so every deque starts
+    // with a similar mix of long and short tasks
+    qsort(order, numTasks, sizeof(TaskOrder), compareTaskCost);
+
+    for (int t = 0; t < threads; t++) {
+        search.deques[t].items = dealt + t * perThread;
+        pthread_mutex_init(&search.deques[t].lock, NULL);
+
+        Arena_reset(ThreadPool_arena(pool, t));
+        search.buffers[t] = ProcessResults_create(ThreadPool_arena(pool, t));
+    }
+    for (int i = 0; i < numTasks; i++) {
+        TaskDeque* deque = &search.deques[i % threads];
+        deque->items[deque->tail++] = order[i].task;
+    }
+
+    double start = monotonicSeconds();
+    ThreadPool_run(pool, stealingWorker, &search);
+    double wall = monotonicSeconds() - start;
+
+    for (int t = 0; t < threads; t++) {
+        stats[t].idle = wall > stats[t].busy ? wall - stats[t].busy : 0.0;
+        pthread_mutex_destroy(&search.deques[t].lock);
+        results->failed |= search.buffers[t].failed;
+        results->candidates += search.buffers[t].candidates;
+        results->firstLetterCandidates += search.buffers[t].firstLetterCandidates;
+    }
+    if (search.state.positions) {
+        // Counted once over the whole range rather than per block
+        results->firstLetterCandidates += countFirstLetterCandidates(search.state.positions, words);
+    }
+
+    // Emit task results in word, then row block order
+    if (wholeList) {
+        // Each block holds every word; take them word by word across blocks
+        ProcessResults parts[numTasks];
+        for (int i = 0; i < numTasks; i++) {
+            const SearchTask* task = &search.tasks[i];
+            parts[i] = (ProcessResults){
+                .positions = search.buffers[task->thread].positions + task->offset,
+                .validResults = task->count
+            };
+        }
+        mergeResultsInWordOrder(parts, numTasks, numWords, results);
+    } else {
+        for (int i = 0; i < numTasks; i++) {
+            const SearchTask* task = &search.tasks[i];
+            const WordPosition* found = search.buffers[task->thread].positions + task->offset;
+
+            for (int k = 0; k < task->count; k++) {
+                ProcessResults_add(results, &found[k]);
+            }
+        }
+    }
+
+    debugPrint("Work stealing: %d tasks of %d rows on %d threads\n", numTasks, blockRows, threads);
+
+    EngineState_release(&search.state);
+    free(search.buffers);
+    free(search.deques);
+    free(search.tasks);
+    free(order);
+    free(dealt);
+}
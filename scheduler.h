@@ -0,0 +1,34 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "types.h"
+#include "grid.h"
+#include "thread_pool.h"
+
+// Word of a task that covers the whole word list
+#define ALL_WORDS -1
+
+// One word, or every word, searched over one block of rows
+typedef struct {
+    int word;           // Index in the word list, or ALL_WORDS
+    RowRange rows;
+    double cost;        // Expected cost, used to run long tasks first
+    int thread;         // Thread that ran the task
+    int offset;         // First result in that thread's buffer
+    int count;          // Results found by the task
+} SearchTask;
+
+// Double-ended queue of task indices. The owner takes from the front
+// (most expensive first), thieves take from the back.
+typedef struct {
+    int* items;
+    int head;
+    int tail;
+    pthread_mutex_t lock;
+} TaskDeque;
+
+void searchWordsStealing(ThreadPool* pool, Grid* grid, const WordList* words,
+                         RowRange range, SearchEngine engine, WorkerStats* stats,
+                         ProcessResults* results);
+
+#endif // SCHEDULER_H
@@ -2,51 +2,150 @@
 #include "debug.h"
 #include "types.h"
 #include "constants.h"
+#include "trie.h"
+#include "lines.h"
+#include "bitplane.h"
+#include "grid_index.h"
+#include "rolling_hash.h"
+#include "anchor.h"
+#include "folded.h"
+#include "thread_pool.h"
+#include "simd_scan.h"
+#include "word_list.h"
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
 
-// extern const DirectionVector DIRECTION_VECTORS[DIRECTIONS_COUNT];
+ProcessResults ProcessResults_create(Arena* arena) {
+    ProcessResults results = {0};
+    results.arena = arena;
+    return results;
+}
 
-bool searchWordInDirection(const Grid* grid, int startRow, int startCol,
-                         Direction dir, const char* word, WordPosition* pos) {
-    debugPrint("DEBUG: Searching for word %s at (%d,%d) in direction %s\n",
-           word, startRow, startCol, DIRECTION_VECTORS[dir].name);
+bool ProcessResults_add(ProcessResults* results, const WordPosition* pos) {
+    if (results->validResults >= results->capacity) {
+        int capacity = results->capacity > 0 ? results->capacity * 2 : INITIAL_GRID_CAPACITY;
+        WordPosition* temp = Arena_grow(results->arena, results->positions,
+                                        results->capacity * sizeof(WordPosition),
+                                        capacity * sizeof(WordPosition));
+        if (!temp) {
+            results->failed = true;
+            return false;
+        }
+        results->positions = temp;
+        results->capacity = capacity;
+    }
+    results->positions[results->validResults++] = *pos;
+    return true;
+}
 
-    int len = strlen(word);
-    if (len == 0) return false;
+void setWordPosition(const Grid* grid, const char* word, int len,
+                     int startRow, int startCol, Direction dir, WordPosition* pos) {
+    DirectionVector vector = DIRECTION_VECTORS[dir];
+
+    pos->startRow = startRow;
+    pos->startCol = startCol;
+    pos->endRow = (startRow + (len-1) * vector.dx + grid->rows) % grid->rows;
+    pos->endCol = (startCol + (len-1) * vector.dy + grid->cols) % grid->cols;
+    pos->dir = dir;
+    pos->word = word;
+}
+
+static int compareHits(const void* a, const void* b) {
+    const SearchHit* x = (const SearchHit*)a;
+    const SearchHit* y = (const SearchHit*)b;
+
+    // Same order as searchWords: word, then row, column and direction
+    if (x->word != y->word) return x->word - y->word;
+    if (x->row != y->row) return x->row - y->row;
+    if (x->col != y->col) return x->col - y->col;
+    return (int)x->dir - (int)y->dir;
+}
+
+bool pushSearchHit(SearchHit** hits, int* numHits, int* capacity, SearchHit hit) {
+    if (*numHits >= *capacity) {
+        SearchHit* temp = realloc(*hits, (*capacity * 2) * sizeof(SearchHit));
+        if (!temp) return false;
+        *hits = temp;
+        *capacity *= 2;
+    }
+    (*hits)[(*numHits)++] = hit;
+    return true;
+}
+
+void appendSortedHits(const Grid* grid, const WordList* words,
+                     SearchHit* hits, int numHits, ProcessResults* results) {
+    qsort(hits, numHits, sizeof(SearchHit), compareHits);
+
+    for (int i = 0; i < numHits; i++) {
+        WordPosition pos;
+        setWordPosition(grid, WordList_word(words, hits[i].word),
+                        WordList_length(words, hits[i].word),
+                        hits[i].row, hits[i].col, hits[i].dir, &pos);
+        pos.wordIndex = hits[i].word;
+        if (!ProcessResults_add(results, &pos)) return;
+    }
+}
+
+int foldWord(const char* word, char* folded) {
+    int len = 0;
+    for (; word[len]; len++) {
+        folded[len] = (char)tolower((unsigned char)word[len]);
+    }
+    folded[len] = '\0';
+    return len;
+}
 
-    // Initialize current position
+// Modulo walk over the original letters, used when the padded layout is
+// missing or its halo is narrower than the word
+static bool matchesWrapped(const Grid* grid, int startRow, int startCol,
+                           Direction dir, const char* folded, int len) {
     int currentRow = startRow;
     int currentCol = startCol;
     DirectionVector vector = DIRECTION_VECTORS[dir];
 
-    // Check each letter
     for (int i = 0; i < len; i++) {
-        // Handle wrapping
         currentRow = (currentRow + grid->rows) % grid->rows;
         currentCol = (currentCol + grid->cols) % grid->cols;
 
-        char gridChar = tolower(grid->letters[currentRow][currentCol]);
-        char wordChar = tolower(word[i]);
-
-        debugPrint("DEBUG: Comparing grid[%d][%d]='%c' with word[%d]='%c'\n",
-               currentRow, currentCol, gridChar, i, wordChar);
-
-        if (gridChar != wordChar) {
+        if (tolower((unsigned char)grid->letters[currentRow][currentCol]) != folded[i]) {
             return false;
         }
 
-        // Move to next position
         currentRow += vector.dx;
         currentCol += vector.dy;
     }
+    return true;
+}
+
+static bool hasSearchLayout(const Grid* grid, int len) {
+    return grid->cells != NULL && len - 1 <= grid->halo;
+}
+
+bool searchWordInDirection(const Grid* grid, int startRow, int startCol,
+                         Direction dir, const char* word, WordPosition* pos) {
+    debugPrint("DEBUG: Searching for word %s at (%d,%d) in direction %s\n",
+           word, startRow, startCol, DIRECTION_VECTORS[dir].name);
+
+    int len = strlen(word);
+    if (len == 0) return false;
+
+    char folded[len + 1];
+    foldWord(word, folded);
+
+    bool found;
+    if (hasSearchLayout(grid, len)) {
+        DirectionVector vector = DIRECTION_VECTORS[dir];
+        found = matchesFoldedWord(Grid_cellPtr(grid, startRow, startCol),
+                                  Grid_stepOffset(grid, vector.dx, vector.dy), folded, len);
+    } else {
+        found = matchesWrapped(grid, startRow, startCol, dir, folded, len);
+    }
+    if (!found) return false;
 
     // Word found - store positions
-    pos->startRow = startRow;
-    pos->startCol = startCol;
-    pos->endRow = (startRow + (len-1) * vector.dx + grid->rows) % grid->rows;
-    pos->endCol = (startCol + (len-1) * vector.dy + grid->cols) % grid->cols;
-    strcpy(pos->word, word);
+    setWordPosition(grid, word, len, startRow, startCol, dir, pos);
 
     debugPrint("DEBUG: Found word! Start=(%d,%d), End=(%d,%d)\n",
            pos->startRow, pos->startCol, pos->endRow, pos->endCol);
@@ -54,43 +153,326 @@ bool searchWordInDirection(const Grid* grid, int startRow, int startCol,
     return true;
 }
 
-void searchWordParallel(const Grid* grid, const char* word, int startRow, int endRow,
-                       WordPosition* positions, int* count) {
-    int localCount = *count;
+static void addMatch(const Grid* grid, const WordList* words, int w, int row, int col,
+                     Direction dir, ProcessResults* results) {
+    WordPosition pos;
+    setWordPosition(grid, WordList_word(words, w), WordList_length(words, w),
+                    row, col, dir, &pos);
+    pos.wordIndex = w;
+    ProcessResults_add(results, &pos);
+}
+
+void searchWordParallel(const Grid* grid, const WordList* words, int w, RowRange range,
+                       ProcessResults* results) {
+    // The word list keeps a folded copy; the grid copy in cells is already lowercase
+    const char* folded = WordList_folded(words, w);
+    int len = WordList_length(words, w);
+    if (len == 0) return;
 
-    for (int i = startRow; i < endRow; i++) {
-        for (int j = 0; j < grid->cols; j++) {
-            for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
-                WordPosition pos;
-                if (searchWordInDirection(grid, i, j, dir, word, &pos)) {
-                    positions[localCount] = pos;
-                    localCount++;
+    if (!hasSearchLayout(grid, len)) {
+        for (int i = range.start; i < range.end; i++) {
+            for (int j = 0; j < grid->cols; j++) {
+                for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+                    if (matchesWrapped(grid, i, j, dir, folded, len)) {
+                        addMatch(grid, words, w, i, j, dir, results);
+                    }
                 }
             }
         }
+        return;
+    }
+
+    int steps[DIRECTIONS_COUNT];
+    for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+        steps[dir] = Grid_stepOffset(grid, DIRECTION_VECTORS[dir].dx, DIRECTION_VECTORS[dir].dy);
+    }
+
+    // Candidate start cells per row, one bit per column
+    int maskWords = (grid->cols + 63) / 64;
+    uint64_t stackMask[16];
+    uint64_t* mask = maskWords <= 16 ? stackMask : (uint64_t*)malloc(maskWords * sizeof(uint64_t));
+    if (!mask) {
+        results->failed = true;
+        return;
     }
 
-    *count = localCount;
+    for (int i = range.start; i < range.end; i++) {
+        const char* rowCells = Grid_cellPtr(grid, i, 0);
+        findCandidateCells(grid, i, folded, len, mask);
+
+        for (int m = 0; m < maskWords; m++) {
+            for (uint64_t bits = mask[m]; bits; bits &= bits - 1) {
+                int j = m * 64 + __builtin_ctzll(bits);
+
+                for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+                    if (matchesFoldedWord(rowCells + j, steps[dir], folded, len)) {
+                        addMatch(grid, words, w, i, j, dir, results);
+                    }
+                }
+            }
+        }
+    }
+
+    if (mask != stackMask) free(mask);
 }
 
-ProcessResults searchWords(Grid* grid, const char words[][MAX_WORD_LENGTH],
-                         int numWords, RowRange range) {
-    ProcessResults results = {0};
+void searchWords(Grid* grid, const WordList* words, RowRange range, ProcessResults* results) {
+    // Halo wide enough for the longest word; a no-op once built
+    Grid_ensureSearchLayout(grid, words->longest - 1);
 
+    for (int w = 0; w < words->count; w++) {
+        int foundBefore = results->validResults;
+
+        searchWordParallel(grid, words, w, range, results);
+        results->totalProcessed++;
+
+        debugPrint("Process found %d instances of word '%s'\n",
+                  results->validResults - foundBefore, WordList_word(words, w));
+    }
+}
+
+// Engines that could not prepare their state fall back to the per-word
+// search rather than losing results. Returns true when it searched.
+bool searchWordsFallback(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results, bool prepared) {
+    if (prepared) return false;
+
+    searchWords(grid, words, range, results);
+    return true;
+}
+
+bool parseSearchEngine(const char* name, SearchEngine* engine) {
+    for (int i = 0; i < SEARCH_ENGINES_COUNT; i++) {
+        if (strcmp(name, SEARCH_ENGINE_NAMES[i]) == 0) {
+            *engine = (SearchEngine)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseSchedule(const char* name, ScheduleMode* schedule) {
+    for (int i = 0; i < SCHEDULES_COUNT; i++) {
+        if (strcmp(name, SCHEDULE_NAMES[i]) == 0) {
+            *schedule = (ScheduleMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseDistribution(const char* name, DistributionMode* distribution) {
+    for (int i = 0; i < DISTRIBUTIONS_COUNT; i++) {
+        if (strcmp(name, DISTRIBUTION_NAMES[i]) == 0) {
+            *distribution = (DistributionMode)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+void searchWordsWithEngine(Grid* grid, const WordList* words, RowRange range,
+                           SearchEngine engine, ProcessResults* results) {
+    switch (engine) {
+        case ENGINE_TRIE:
+            searchWordsTrie(grid, words, range, results);
+            break;
+        case ENGINE_LINES:
+            searchWordsLines(grid, words, range, results);
+            break;
+        case ENGINE_BITPLANE:
+            searchWordsBitplane(grid, words, range, results);
+            break;
+        case ENGINE_INDEX:
+            searchWordsIndexed(grid, words, range, results);
+            break;
+        case ENGINE_ROLLING:
+            searchWordsRolling(grid, words, range, results);
+            break;
+        case ENGINE_ANCHOR:
+            searchWordsAnchored(grid, words, range, results);
+            break;
+        case ENGINE_FOLDED:
+            searchWordsFolded(grid, words, range, results);
+            break;
+        case ENGINE_BRUTE:
+        default:
+            searchWords(grid, words, range, results);
+            break;
+    }
+}
+
+RowRange splitRowRange(RowRange range, int part, int parts) {
+    int totalRows = range.end - range.start;
+    int baseRows = totalRows / parts;
+    int extraRows = totalRows % parts;
+
+    RowRange piece;
+    piece.start = range.start + part * baseRows + (part < extraRows ? part : extraRows);
+    piece.end = piece.start + baseRows + (part < extraRows ? 1 : 0);
+    return piece;
+}
+
+void mergeResultsInWordOrder(const ProcessResults* parts, int numParts, int numWords,
+                             ProcessResults* merged) {
+    int next[numParts];
+    for (int t = 0; t < numParts; t++) {
+        next[t] = 0;
+        merged->failed |= parts[t].failed;
+        merged->candidates += parts[t].candidates;
+        merged->firstLetterCandidates += parts[t].firstLetterCandidates;
+    }
+
+    // Parts are in row order, so taking each word from every part in turn
+    // reproduces the order of a single searchWords call
     for (int w = 0; w < numWords; w++) {
-        int foundBefore = results.validResults;
-        int newFound = 0;
+        for (int t = 0; t < numParts; t++) {
+            while (next[t] < parts[t].validResults &&
+                   parts[t].positions[next[t]].wordIndex == w) {
+                ProcessResults_add(merged, &parts[t].positions[next[t]]);
+                next[t]++;
+            }
+        }
+    }
+}
 
-        searchWordParallel(grid, words[w], range.start, range.end,
-                          results.positions + results.validResults,
-                          &newFound);
+void appendProcessResults(ProcessResults* into, const ProcessResults* from) {
+    for (int i = 0; i < from->validResults; i++) {
+        ProcessResults_add(into, &from->positions[i]);
+    }
+    into->failed |= from->failed;
+    into->candidates += from->candidates;
+    into->firstLetterCandidates += from->firstLetterCandidates;
+    if (from->totalProcessed > into->totalProcessed) {
+        into->totalProcessed = from->totalProcessed;
+    }
+}
 
-        results.validResults += newFound;
-        results.totalProcessed++;
+typedef struct {
+    int wordIndex;
+    int startRow;
+    int startCol;
+    int order;          // Original position, keeps directions of one cell in order
+} ResultKey;
 
-        debugPrint("Process found %d instances of word '%s'\n",
-                  newFound, words[w]);
+static int compareResultKeys(const void* a, const void* b) {
+    const ResultKey* x = (const ResultKey*)a;
+    const ResultKey* y = (const ResultKey*)b;
+
+    if (x->wordIndex != y->wordIndex) return x->wordIndex - y->wordIndex;
+    if (x->startRow != y->startRow) return x->startRow - y->startRow;
+    if (x->startCol != y->startCol) return x->startCol - y->startCol;
+    return x->order - y->order;
+}
+
+void sortResultsInWordOrder(ProcessResults* results) {
+    int count = results->validResults;
+    ResultKey* keys = (ResultKey*)malloc((count > 0 ? count : 1) * sizeof(ResultKey));
+    WordPosition* sorted = (WordPosition*)malloc((count > 0 ? count : 1) * sizeof(WordPosition));
+
+    if (keys && sorted) {
+        for (int i = 0; i < count; i++) {
+            const WordPosition* pos = &results->positions[i];
+            keys[i] = (ResultKey){pos->wordIndex, pos->startRow, pos->startCol, i};
+        }
+        qsort(keys, count, sizeof(ResultKey), compareResultKeys);
+
+        for (int i = 0; i < count; i++) {
+            sorted[i] = results->positions[keys[i].order];
+        }
+        memcpy(results->positions, sorted, count * sizeof(WordPosition));
     }
 
-    return results;
+    free(keys);
+    free(sorted);
+}
+
+// Moves results found on a tile into grid coordinates. End cells are
+// recomputed so they wrap around the whole grid rather than the tile.
+void offsetResults(ProcessResults* results, int rowOffset, int colOffset,
+                   int gridRows, int gridCols) {
+    Grid whole = {.rows = gridRows, .cols = gridCols};
+
+    for (int i = 0; i < results->validResults; i++) {
+        WordPosition found = results->positions[i];
+        setWordPosition(&whole, found.word, strlen(found.word), found.startRow + rowOffset,
+                        found.startCol + colOffset, found.dir, &results->positions[i]);
+    }
+}
+
+// Builds the padded layout and resolves the candidate scan, which the
+// search threads then only read; lazy setup inside them would race
+void prepareSharedSearchState(Grid* grid, const WordList* words) {
+    Grid_ensureSearchLayout(grid, words->longest - 1);
+    initCandidateScan();
+}
+
+typedef struct {
+    ThreadPool* pool;
+    Grid* grid;
+    const WordList* words;
+    RowRange range;
+    SearchEngine engine;
+    bool splitWords;        // Split the word list instead of the rows
+    int parts;
+    ProcessResults* partial;
+} ThreadedSearch;
+
+static void runSearchPart(int thread, void* context) {
+    ThreadedSearch* search = (ThreadedSearch*)context;
+    ProcessResults* out = &search->partial[thread];
+
+    // Each part lives in its thread's scratch arena until merged
+    Arena* scratch = ThreadPool_arena(search->pool, thread);
+    Arena_reset(scratch);
+    *out = ProcessResults_create(scratch);
+
+    if (!search->splitWords) {
+        searchWordsWithEngine(search->grid, search->words,
+                              splitRowRange(search->range, thread, search->parts),
+                              search->engine, out);
+        return;
+    }
+
+    RowRange wordRange = splitRowRange((RowRange){0, search->words->count}, thread, search->parts);
+    WordList slice = WordList_slice(search->words, wordRange.start,
+                                    wordRange.end - wordRange.start);
+    searchWordsWithEngine(search->grid, &slice, search->range, search->engine, out);
+    for (int i = 0; i < out->validResults; i++) {
+        out->positions[i].wordIndex += wordRange.start;
+    }
+}
+
+void searchWordsThreaded(ThreadPool* pool, Grid* grid, const WordList* words,
+                         RowRange range, SearchEngine engine, ProcessResults* results) {
+    if (!pool || pool->threadCount <= 1) {
+        searchWordsWithEngine(grid, words, range, engine, results);
+        return;
+    }
+
+    prepareSharedSearchState(grid, words);
+
+    ProcessResults partial[pool->threadCount];
+    ThreadedSearch search = {
+        .pool = pool,
+        .grid = grid,
+        .words = words,
+        .range = range,
+        .engine = engine,
+        .splitWords = range.end - range.start < pool->threadCount,
+        .parts = pool->threadCount,
+        .partial = partial
+    };
+
+    ThreadPool_run(pool, runSearchPart, &search);
+
+    int foundBefore = results->validResults;
+    mergeResultsInWordOrder(search.partial, search.parts, words->count, results);
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+
+    debugPrint("Threaded search: %d threads split by %s, %d matches\n",
+               search.parts, search.splitWords ? "words" : "rows",
+               results->validResults - foundBefore);
 }
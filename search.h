@@ -3,12 +3,48 @@
 
 #include "types.h"
 #include "grid.h"
+#include "thread_pool.h"
+#include "word_list.h"
 
+// Compares a case-folded word against the padded search layout, moving
+// step bytes per letter from cell
+static inline bool matchesFoldedWord(const char* cell, int step,
+                                     const char* folded, int len) {
+    for (int i = 0; i < len; i++, cell += step) {
+        if (*cell != folded[i]) return false;
+    }
+    return true;
+}
+
+ProcessResults ProcessResults_create(Arena* arena);
+bool ProcessResults_add(ProcessResults* results, const WordPosition* pos);
+int foldWord(const char* word, char* folded);
+void setWordPosition(const Grid* grid, const char* word, int len,
+                     int startRow, int startCol, Direction dir, WordPosition* pos);
+bool pushSearchHit(SearchHit** hits, int* numHits, int* capacity, SearchHit hit);
+void appendSortedHits(const Grid* grid, const WordList* words,
+                     SearchHit* hits, int numHits, ProcessResults* results);
 bool searchWordInDirection(const Grid* grid, int startRow, int startCol,
                          Direction dir, const char* word, WordPosition* pos);
-void searchWordParallel(const Grid* grid, const char* word, int startRow,
-                       int endRow, WordPosition* positions, int* count);
-ProcessResults searchWords(Grid* grid, const char words[][MAX_WORD_LENGTH],
-                         int numWords, RowRange range);
+void searchWordParallel(const Grid* grid, const WordList* words, int w, RowRange range,
+                       ProcessResults* results);
+void searchWords(Grid* grid, const WordList* words, RowRange range, ProcessResults* results);
+bool searchWordsFallback(Grid* grid, const WordList* words, RowRange range,
+                         ProcessResults* results, bool prepared);
+bool parseSearchEngine(const char* name, SearchEngine* engine);
+bool parseSchedule(const char* name, ScheduleMode* schedule);
+bool parseDistribution(const char* name, DistributionMode* distribution);
+void searchWordsWithEngine(Grid* grid, const WordList* words, RowRange range,
+                           SearchEngine engine, ProcessResults* results);
+RowRange splitRowRange(RowRange range, int part, int parts);
+void mergeResultsInWordOrder(const ProcessResults* parts, int numParts, int numWords,
+                             ProcessResults* merged);
+void appendProcessResults(ProcessResults* into, const ProcessResults* from);
+void sortResultsInWordOrder(ProcessResults* results);
+void offsetResults(ProcessResults* results, int rowOffset, int colOffset,
+                   int gridRows, int gridCols);
+void prepareSharedSearchState(Grid* grid, const WordList* words);
+void searchWordsThreaded(ThreadPool* pool, Grid* grid, const WordList* words,
+                         RowRange range, SearchEngine engine, ProcessResults* results);
 
 #endif // SEARCH_H
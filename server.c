@@ -0,0 +1,522 @@
+#define _GNU_SOURCE
+#include "server.h"
+#include "file_io.h"
+#include "dictionary.h"
+#include "grid_index.h"
+#include "gram_filter.h"
+#include "grid.h"
+#include "search.h"
+#include "thread_pool.h"
+#include "word_list.h"
+#include "constants.h"
+#include "debug.h"
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+// Latency buckets: under 1 us, then powers of two up to an open-ended last
+#define LATENCY_BUCKETS 24
+
+typedef enum {
+    REQUEST_FIND,
+    REQUEST_SOLVE,
+    REQUEST_OTHER,
+    REQUEST_KINDS
+} RequestKind;
+
+static const char* const REQUEST_NAMES[REQUEST_KINDS] = {"FIND", "SOLVE", "other"};
+
+typedef struct {
+    long counts[LATENCY_BUCKETS];
+    long requests;
+    double totalSeconds;
+    double maxSeconds;
+} LatencyHistogram;
+
+// Response text built up before it is written in one go
+typedef struct {
+    char* data;
+    size_t size;
+    size_t capacity;
+    bool failed;        // Memory ran out; the response is incomplete
+} Reply;
+
+typedef struct {
+    int fd;
+    char* buffer;       // Bytes received but not yet handled
+    size_t used;
+    size_t capacity;
+} Client;
+
+typedef enum {
+    CLIENT_KEEP,
+    CLIENT_CLOSE,
+    SERVER_STOP
+} RequestOutcome;
+
+// Everything a query needs stays prepared between requests
+typedef struct {
+    Grid* grid;
+    WordList words;             // The puzzle's own list or the dictionary, searched by SOLVE
+    ThreadPool* pool;
+    Arena* requestArena;        // Query words and results, reset per request
+    const SearchOptions* searchOptions;
+    const GramFilter* filter;   // Grams of the grid with --prefilter, or NULL
+    LatencyHistogram latency[REQUEST_KINDS];
+    Reply reply;                // Reused for every response
+} SearchServer;
+
+// Set by SIGINT and SIGTERM; the event loop stops when poll is interrupted
+static volatile sig_atomic_t stopRequested = 0;
+
+static void requestStop(int signal) {
+    (void)signal;
+    stopRequested = 1;
+}
+
+static void Reply_printf(Reply* reply, const char* format, ...) {
+    while (!reply->failed) {
+        size_t room = reply->capacity - reply->size;
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(reply->data ? reply->data + reply->size : NULL, room, format, args);
+        va_end(args);
+
+        if (length < 0) {
+            reply->failed = true;
+        } else if ((size_t)length < room) {
+            reply->size += length;
+            return;
+        } else {
+            size_t capacity = reply->capacity > 0 ? reply->capacity : 4096;
+            while (capacity - reply->size <= (size_t)length) capacity *= 2;
+            char* temp = (char*)realloc(reply->data, capacity);
+            if (!temp) {
+                reply->failed = true;
+            } else {
+                reply->data = temp;
+                reply->capacity = capacity;
+            }
+        }
+    }
+}
+
+static bool sendAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+        data += sent;
+        size -= sent;
+    }
+    return true;
+}
+
+static void recordLatency(LatencyHistogram* histogram, double seconds) {
+    double micros = seconds * 1e6;
+    int bucket = 0;
+    while (bucket < LATENCY_BUCKETS - 1 && micros >= (double)(1L << bucket)) bucket++;
+
+    histogram->counts[bucket]++;
+    histogram->requests++;
+    histogram->totalSeconds += seconds;
+    if (seconds > histogram->maxSeconds) histogram->maxSeconds = seconds;
+}
+
+static void formatLatency(Reply* reply, const LatencyHistogram* latency) {
+    for (int kind = 0; kind < REQUEST_KINDS; kind++) {
+        const LatencyHistogram* histogram = &latency[kind];
+        if (histogram->requests == 0) continue;
+
+        Reply_printf(reply, "%s: %ld requests, mean %.1f us, max %.1f us\n",
+                     REQUEST_NAMES[kind], histogram->requests,
+                     histogram->totalSeconds * 1e6 / histogram->requests,
+                     histogram->maxSeconds * 1e6);
+        for (int bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+            if (histogram->counts[bucket] == 0) continue;
+            if (bucket == 0) {
+                Reply_printf(reply, "  < 1 us: %ld\n", histogram->counts[bucket]);
+            } else if (bucket == LATENCY_BUCKETS - 1) {
+                Reply_printf(reply, "  >= %ld us: %ld\n", 1L << (bucket - 1),
+                             histogram->counts[bucket]);
+            } else {
+                Reply_printf(reply, "  %ld-%ld us: %ld\n", 1L << (bucket - 1), 1L << bucket,
+                             histogram->counts[bucket]);
+            }
+        }
+    }
+}
+
+static bool isQuerySeparator(char c) {
+    return c == ',' || isspace((unsigned char)c);
+}
+
+// Words of a FIND request, separated like the puzzle's word list
+static bool parseQueryWords(const char* c, const char* end, Arena* arena, WordList* words) {
+    int count = 0;
+    size_t letters = 0;
+    for (const char* p = c; p < end; ) {
+        while (p < end && isQuerySeparator(*p)) p++;
+        if (p == end) break;
+
+        const char* start = p;
+        while (p < end && !isQuerySeparator(*p)) p++;
+        letters += p - start;
+        count++;
+    }
+
+    if (!WordList_init(words, arena, count, letters)) return false;
+
+    int index = 0;
+    for (const char* p = c; p < end; ) {
+        while (p < end && isQuerySeparator(*p)) p++;
+        if (p == end) break;
+
+        const char* start = p;
+        while (p < end && !isQuerySeparator(*p)) p++;
+        WordList_set(words, index++, start, p - start);
+    }
+    return true;
+}
+
+// Searches the whole grid for words, one line per match, then the count
+static void answerSearch(SearchServer* server, const WordList* words, double start) {
+    Reply* reply = &server->reply;
+
+    // Words the grid cannot hold are never searched
+    const WordList* searched = words;
+    WordList kept;
+    int* original = NULL;
+    if (server->filter) {
+        if (GramFilter_apply(server->filter, words, server->requestArena, &kept, &original) < 0) {
+            Reply_printf(reply, "ERR out of memory\n");
+            return;
+        }
+        searched = &kept;
+    }
+
+    ProcessResults results = ProcessResults_create(server->requestArena);
+    searchWordsThreaded(server->pool, server->grid, searched, (RowRange){0, server->grid->rows},
+                        server->searchOptions->engine, &results);
+    if (results.failed) {
+        Reply_printf(reply, "ERR out of memory\n");
+        return;
+    }
+    if (original) {
+        remapWordIndices(&results, 0, original, words);
+    }
+
+    for (int i = 0; i < results.validResults; i++) {
+        const WordPosition* pos = &results.positions[i];
+        Reply_printf(reply, "%s: (%d,%d) to (%d,%d)\n", pos->word, pos->startRow,
+                     pos->startCol, pos->endRow, pos->endCol);
+    }
+    Reply_printf(reply, "OK %d found in %.1f us\n", results.validResults,
+                 (MPI_Wtime() - start) * 1e6);
+}
+
+static bool isCommand(const char* token, size_t length, const char* command) {
+    return length == strlen(command) && strncasecmp(token, command, length) == 0;
+}
+
+// Answers one request line:
+//   FIND <word> [<word> ...]   matches of the given words
+//   SOLVE                      matches of the puzzle's own word list
+//   INFO                       puzzle dimensions and search settings
+//   STATS                      latency histograms so far
+//   QUIT                       closes this connection
+//   SHUTDOWN                   stops the server
+static RequestOutcome handleRequest(SearchServer* server, Client* client,
+                                    const char* line, size_t length) {
+    double start = MPI_Wtime();
+    const char* end = line + length;
+    while (line < end && isspace((unsigned char)*line)) line++;
+    if (line == end) return CLIENT_KEEP;
+
+    const char* command = line;
+    while (line < end && !isspace((unsigned char)*line)) line++;
+    size_t commandLength = line - command;
+
+    Reply* reply = &server->reply;
+    reply->size = 0;
+    reply->failed = false;
+    Arena_reset(server->requestArena);
+
+    RequestKind kind = REQUEST_OTHER;
+    RequestOutcome outcome = CLIENT_KEEP;
+    if (isCommand(command, commandLength, "FIND")) {
+        WordList words;
+        kind = REQUEST_FIND;
+        if (parseQueryWords(line, end, server->requestArena, &words)) {
+            answerSearch(server, &words, start);
+        } else {
+            Reply_printf(reply, "ERR out of memory\n");
+        }
+    } else if (isCommand(command, commandLength, "SOLVE")) {
+        kind = REQUEST_SOLVE;
+        answerSearch(server, &server->words, start);
+    } else if (isCommand(command, commandLength, "INFO")) {
+        Reply_printf(reply, "OK %d columns x %d rows, %d words, %s engine, %d threads\n",
+                     server->grid->cols, server->grid->rows, server->words.count,
+                     SEARCH_ENGINE_NAMES[server->searchOptions->engine],
+                     server->searchOptions->threads);
+    } else if (isCommand(command, commandLength, "STATS")) {
+        formatLatency(reply, server->latency);
+        Reply_printf(reply, "OK\n");
+    } else if (isCommand(command, commandLength, "QUIT")) {
+        Reply_printf(reply, "OK bye\n");
+        outcome = CLIENT_CLOSE;
+    } else if (isCommand(command, commandLength, "SHUTDOWN")) {
+        Reply_printf(reply, "OK shutting down\n");
+        outcome = SERVER_STOP;
+    } else {
+        Reply_printf(reply, "ERR unknown request '%.*s'\n", (int)commandLength, command);
+    }
+
+    if (reply->failed) {
+        reply->size = 0;
+        reply->failed = false;
+        Reply_printf(reply, "ERR out of memory\n");
+    }
+    if (!sendAll(client->fd, reply->data, reply->size) && outcome == CLIENT_KEEP) {
+        outcome = CLIENT_CLOSE;
+    }
+
+    recordLatency(&server->latency[kind], MPI_Wtime() - start);
+    return outcome;
+}
+
+// Reads what the client sent and answers every complete line
+static RequestOutcome serveClient(SearchServer* server, Client* client) {
+    if (client->used == client->capacity) {
+        size_t capacity = client->capacity > 0 ? client->capacity * 2 : 4096;
+        if (capacity > SERVER_MAX_REQUEST + 1) capacity = SERVER_MAX_REQUEST + 1;
+        char* temp = capacity > client->capacity ? (char*)realloc(client->buffer, capacity) : NULL;
+        if (!temp) {
+            const char* refusal = "ERR request too long\n";
+            sendAll(client->fd, refusal, strlen(refusal));
+            return CLIENT_CLOSE;
+        }
+        client->buffer = temp;
+        client->capacity = capacity;
+    }
+
+    ssize_t got = read(client->fd, client->buffer + client->used,
+                       client->capacity - client->used);
+    if (got < 0 && errno == EINTR) return CLIENT_KEEP;
+    if (got <= 0) return CLIENT_CLOSE;
+    client->used += got;
+
+    size_t pos = 0;
+    RequestOutcome outcome = CLIENT_KEEP;
+    while (outcome == CLIENT_KEEP) {
+        char* newline = (char*)memchr(client->buffer + pos, '\n', client->used - pos);
+        if (!newline) break;
+
+        size_t length = newline - (client->buffer + pos);
+        if (length > 0 && client->buffer[pos + length - 1] == '\r') length--;
+        outcome = handleRequest(server, client, client->buffer + pos, length);
+        pos = newline - client->buffer + 1;
+    }
+
+    memmove(client->buffer, client->buffer + pos, client->used - pos);
+    client->used -= pos;
+    return outcome;
+}
+
+// Listening socket at path. A stale socket left by an earlier server is
+// replaced; any other file there is left alone.
+static int openServerSocket(const char* path) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Error: Socket path %s is too long\n", path);
+        return -1;
+    }
+
+    struct stat info;
+    if (lstat(path, &info) == 0) {
+        if (!S_ISSOCK(info.st_mode)) {
+            fprintf(stderr, "Error: %s exists and is not a socket\n", path);
+            return -1;
+        }
+        unlink(path);
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Error: socket");
+        return -1;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 ||
+        listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Error: Failed to listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Serves queries until SHUTDOWN or a signal
+static void runEventLoop(SearchServer* server, int listenFd) {
+    struct pollfd fds[SERVER_MAX_CLIENTS + 1];
+    Client clients[SERVER_MAX_CLIENTS];
+    int numClients = 0;
+    bool stopping = false;
+
+    while (!stopping && !stopRequested) {
+        fds[0] = (struct pollfd){listenFd, POLLIN, 0};
+        for (int i = 0; i < numClients; i++) {
+            fds[i + 1] = (struct pollfd){clients[i].fd, POLLIN, 0};
+        }
+
+        int polled = numClients;
+        if (poll(fds, polled + 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            perror("Error: poll");
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            int fd = accept(listenFd, NULL, NULL);
+            if (fd >= 0 && numClients < SERVER_MAX_CLIENTS) {
+                clients[numClients++] = (Client){fd, NULL, 0, 0};
+                debugPrint("DEBUG Server: client %d connected\n", fd);
+            } else if (fd >= 0) {
+                const char* refusal = "ERR too many connections\n";
+                sendAll(fd, refusal, strlen(refusal));
+                close(fd);
+            }
+        }
+
+        // Backwards, so a closed client can take the last slot's place
+        for (int i = polled - 1; i >= 0; i--) {
+            if (!(fds[i + 1].revents & (POLLIN | POLLHUP | POLLERR))) continue;
+
+            RequestOutcome outcome = serveClient(server, &clients[i]);
+            if (outcome == SERVER_STOP) stopping = true;
+            if (outcome != CLIENT_KEEP) {
+                close(clients[i].fd);
+                free(clients[i].buffer);
+                clients[i] = clients[--numClients];
+            }
+        }
+    }
+
+    for (int i = 0; i < numClients; i++) {
+        close(clients[i].fd);
+        free(clients[i].buffer);
+    }
+}
+
+// Loads the puzzle once, prepares its search layout and answers queries on
+// a Unix domain socket at socketPath, one request per line. Latency
+// histograms are printed when the server stops.
+bool runSearchServer(const char* socketPath, const OutputOptions* options,
+                     const SearchOptions* searchOptions) {
+    SearchServer server;
+    memset(&server, 0, sizeof(SearchServer));
+    server.searchOptions = searchOptions;
+
+    Arena* arena = Arena_create(0);
+    server.requestArena = Arena_create(0);
+    server.pool = ThreadPool_create(searchOptions->threads);
+    if (!arena || !server.requestArena || !server.pool) {
+        fprintf(stderr, "Error: Failed to start search threads\n");
+        return false;
+    }
+
+    // A binary puzzle's grid stays in the mapped input, so input is kept
+    // open while the server runs
+    PuzzleInput input;
+    const char* inputFile = options->inputFile;
+    if (!PuzzleInput_open(inputFile, &input)) {
+        fprintf(stderr, "Error: Failed to open puzzle %s\n", inputFile ? inputFile : "from stdin");
+        return false;
+    }
+    server.grid = readPuzzle(&input, arena, &server.words);
+    if (!server.grid) {
+        fprintf(stderr, "Error: Failed to read puzzle\n");
+        return false;
+    }
+
+    // A compiled dictionary replaces the puzzle's words for SOLVE and stays
+    // mapped while the server runs
+    Dictionary dictionary;
+    memset(&dictionary, 0, sizeof(Dictionary));
+    if (options->dictionaryFile) {
+        if (!Dictionary_open(options->dictionaryFile, &dictionary)) return false;
+        server.words = dictionary.words;
+    }
+
+    // Prepared once; a longer query word widens the halo the first time
+    prepareSharedSearchState(server.grid, &server.words);
+
+    // Every query reuses the index, so its cost is paid once at start
+    GridIndex* index = NULL;
+    if (searchOptions->engine == ENGINE_INDEX) {
+        double indexStart = MPI_Wtime();
+        index = GridIndex_open(server.grid, options->indexFile, true);
+        server.grid->index = index;
+        if (index) {
+            printf("Grid index %s in %.4f seconds\n", index->mapping ? "loaded" : "built",
+                   MPI_Wtime() - indexStart);
+        }
+    }
+
+    // The grid never changes, so its grams are recorded once for every query
+    GramFilter* filter = NULL;
+    if (searchOptions->prefilter && Grid_ensureSearchLayout(server.grid, 2)) {
+        filter = GramFilter_create(3);
+        if (filter) GramFilter_addRows(filter, server.grid, (RowRange){0, server.grid->rows});
+        server.filter = filter;
+    }
+
+    int listenFd = openServerSocket(socketPath);
+    if (listenFd < 0) return false;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = requestStop;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    printf("Serving %s: %d columns x %d rows, %d words, %s engine, %d threads\n",
+           socketPath, server.grid->cols, server.grid->rows, server.words.count,
+           SEARCH_ENGINE_NAMES[searchOptions->engine], searchOptions->threads);
+    fflush(stdout);
+
+    runEventLoop(&server, listenFd);
+    close(listenFd);
+    unlink(socketPath);
+
+    server.reply.size = 0;
+    Reply_printf(&server.reply, "\nServer Latency:\n---------------\n");
+    formatLatency(&server.reply, server.latency);
+    fwrite(server.reply.data, 1, server.reply.size, stdout);
+
+    free(server.reply.data);
+    Grid_destroy(server.grid);
+    GridIndex_destroy(index);
+    GramFilter_destroy(filter);
+    Dictionary_close(&dictionary);
+    PuzzleInput_close(&input);
+    ThreadPool_destroy(server.pool);
+    Arena_destroy(server.requestArena);
+    Arena_destroy(arena);
+    return true;
+}
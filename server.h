@@ -0,0 +1,13 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "types.h"
+
+// Requests longer than this are refused and the connection closed
+#define SERVER_MAX_REQUEST (1 << 20)
+#define SERVER_MAX_CLIENTS 64
+
+bool runSearchServer(const char* socketPath, const OutputOptions* options,
+                     const SearchOptions* searchOptions);
+
+#endif // SERVER_H
@@ -0,0 +1,289 @@
+#include "simd_scan.h"
+#include "debug.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define HAVE_X86_SIMD 1
+#else
+#define HAVE_X86_SIMD 0
+#endif
+
+typedef void (*CandidateScanFn)(const char* row, int stride, int cols,
+                                char first, char second, bool useSecond,
+                                uint64_t* mask);
+typedef void (*LetterScanFn)(const char* row, int cols, const char* letters,
+                             uint64_t* const* masks);
+
+static const char* const SCAN_LEVEL_NAMES[SCAN_LEVELS_COUNT] = {
+    "auto", "scalar", "sse2", "avx2"
+};
+
+static ScanLevel requestedLevel = SCAN_AUTO;
+static ScanLevel activeLevel = SCAN_AUTO;
+static CandidateScanFn activeScan = NULL;
+static LetterScanFn activeLetterScan = NULL;
+
+static inline bool hasSecondLetter(const char* cell, int stride, char second) {
+    return cell[-stride - 1] == second || cell[-stride] == second ||
+           cell[-stride + 1] == second || cell[-1] == second ||
+           cell[1] == second || cell[stride - 1] == second ||
+           cell[stride] == second || cell[stride + 1] == second;
+}
+
+static void scanRange(const char* row, int stride, int from, int to,
+                      char first, char second, bool useSecond, uint64_t* mask) {
+    for (int j = from; j < to; j++) {
+        if (row[j] != first) continue;
+        if (useSecond && !hasSecondLetter(row + j, stride, second)) continue;
+        mask[j >> 6] |= 1ULL << (j & 63);
+    }
+}
+
+static void scanScalar(const char* row, int stride, int cols, char first,
+                       char second, bool useSecond, uint64_t* mask) {
+    scanRange(row, stride, 0, cols, first, second, useSecond, mask);
+}
+
+// ORs the bits of cells j, j + 1, ... into mask; j need not be aligned.
+// Bits carried into the next word belong to cells that exist.
+static inline void setMaskBits(uint64_t* mask, int j, uint32_t bits) {
+    int shift = j & 63;
+    mask[j >> 6] |= (uint64_t)bits << shift;
+    uint64_t carry = shift > 32 ? (uint64_t)bits >> (64 - shift) : 0;
+    if (carry) mask[(j >> 6) + 1] |= carry;
+}
+
+static void letterRange(const char* row, int from, int to, const char* letters,
+                        uint64_t* const* masks) {
+    for (int j = from; j < to; j++) {
+        for (int i = 0; i < SCAN_LETTERS; i++) {
+            if (row[j] == letters[i]) masks[i][j >> 6] |= 1ULL << (j & 63);
+        }
+    }
+}
+
+static void clearMasks(uint64_t* const* masks, int cols) {
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        memset(masks[i], 0, ((cols + 63) / 64) * sizeof(uint64_t));
+    }
+}
+
+static void letterScalar(const char* row, int cols, const char* letters, uint64_t* const* masks) {
+    clearMasks(masks, cols);
+    letterRange(row, 0, cols, letters, masks);
+}
+
+#if HAVE_X86_SIMD
+__attribute__((target("sse2")))
+static void scanSSE2(const char* row, int stride, int cols, char first,
+                     char second, bool useSecond, uint64_t* mask) {
+    const __m128i a = _mm_set1_epi8(first);
+    const __m128i b = _mm_set1_epi8(second);
+    const int offsets[8] = {-stride - 1, -stride, -stride + 1, -1,
+                            1, stride - 1, stride, stride + 1};
+    int j = 0;
+
+    for (; j + 16 <= cols; j += 16) {
+        const char* cell = row + j;
+        __m128i hit = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)cell), a);
+        if (_mm_movemask_epi8(hit) == 0) continue;
+
+        if (useSecond) {
+            __m128i near = _mm_setzero_si128();
+            for (int k = 0; k < 8; k++) {
+                __m128i v = _mm_loadu_si128((const __m128i*)(cell + offsets[k]));
+                near = _mm_or_si128(near, _mm_cmpeq_epi8(v, b));
+            }
+            hit = _mm_and_si128(hit, near);
+        }
+
+        uint64_t bits = (uint32_t)_mm_movemask_epi8(hit);
+        mask[j >> 6] |= bits << (j & 63);
+    }
+
+    scanRange(row, stride, j, cols, first, second, useSecond, mask);
+}
+
+__attribute__((target("avx2")))
+static void scanAVX2(const char* row, int stride, int cols, char first,
+                     char second, bool useSecond, uint64_t* mask) {
+    const __m256i a = _mm256_set1_epi8(first);
+    const __m256i b = _mm256_set1_epi8(second);
+    const int offsets[8] = {-stride - 1, -stride, -stride + 1, -1,
+                            1, stride - 1, stride, stride + 1};
+    int j = 0;
+
+    for (; j + 32 <= cols; j += 32) {
+        const char* cell = row + j;
+        __m256i hit = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)cell), a);
+        if (_mm256_movemask_epi8(hit) == 0) continue;
+
+        if (useSecond) {
+            __m256i near = _mm256_setzero_si256();
+            for (int k = 0; k < 8; k++) {
+                __m256i v = _mm256_loadu_si256((const __m256i*)(cell + offsets[k]));
+                near = _mm256_or_si256(near, _mm256_cmpeq_epi8(v, b));
+            }
+            hit = _mm256_and_si256(hit, near);
+        }
+
+        // 32-bit blocks never straddle a 64-bit mask word since j is a multiple of 32
+        uint64_t bits = (uint32_t)_mm256_movemask_epi8(hit);
+        mask[j >> 6] |= bits << (j & 63);
+    }
+
+    scanRange(row, stride, j, cols, first, second, useSecond, mask);
+}
+
+// One load per block of cells, compared against every letter
+__attribute__((target("sse2")))
+static inline void letterBlockSSE2(const char* cell, int j, const __m128i* letters,
+                                   uint64_t* const* masks) {
+    __m128i v = _mm_loadu_si128((const __m128i*)cell);
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        setMaskBits(masks[i], j, (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, letters[i])));
+    }
+}
+
+__attribute__((target("sse2")))
+static void letterSSE2(const char* row, int cols, const char* letters, uint64_t* const* masks) {
+    __m128i broadcast[SCAN_LETTERS];
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        broadcast[i] = _mm_set1_epi8(letters[i]);
+    }
+    clearMasks(masks, cols);
+
+    int j = 0;
+    for (; j + 16 <= cols; j += 16) {
+        letterBlockSSE2(row + j, j, broadcast, masks);
+    }
+
+    // The last block overlaps the one before rather than leaving a scalar tail
+    if (j < cols && cols >= 16) {
+        letterBlockSSE2(row + cols - 16, cols - 16, broadcast, masks);
+    } else {
+        letterRange(row, j, cols, letters, masks);
+    }
+}
+
+__attribute__((target("avx2")))
+static inline void letterBlockAVX2(const char* cell, int j, const __m256i* letters,
+                                   uint64_t* const* masks) {
+    __m256i v = _mm256_loadu_si256((const __m256i*)cell);
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        setMaskBits(masks[i], j, (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, letters[i])));
+    }
+}
+
+__attribute__((target("avx2")))
+static void letterAVX2(const char* row, int cols, const char* letters, uint64_t* const* masks) {
+    __m256i broadcast[SCAN_LETTERS];
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        broadcast[i] = _mm256_set1_epi8(letters[i]);
+    }
+
+    // Whole mask words from two blocks at a time
+    int j = 0;
+    for (; j + 64 <= cols; j += 64) {
+        __m256i low = _mm256_loadu_si256((const __m256i*)(row + j));
+        __m256i high = _mm256_loadu_si256((const __m256i*)(row + j + 32));
+        for (int i = 0; i < SCAN_LETTERS; i++) {
+            uint32_t lowBits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, broadcast[i]));
+            uint32_t highBits = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, broadcast[i]));
+            masks[i][j >> 6] = (uint64_t)highBits << 32 | lowBits;
+        }
+    }
+    if (j == cols) return;
+
+    for (int i = 0; i < SCAN_LETTERS; i++) {
+        masks[i][j >> 6] = 0;
+    }
+    if (j + 32 <= cols) {
+        letterBlockAVX2(row + j, j, broadcast, masks);
+        j += 32;
+    }
+
+    // The last block overlaps the one before rather than leaving a scalar tail
+    if (j < cols && cols >= 32) {
+        letterBlockAVX2(row + cols - 32, cols - 32, broadcast, masks);
+    } else {
+        letterRange(row, j, cols, letters, masks);
+    }
+}
+#endif
+
+static bool cpuSupports(ScanLevel level) {
+#if HAVE_X86_SIMD
+    __builtin_cpu_init();
+    switch (level) {
+        case SCAN_AVX2: return __builtin_cpu_supports("avx2");
+        case SCAN_SSE2: return __builtin_cpu_supports("sse2");
+        default: return true;
+    }
+#else
+    return level == SCAN_SCALAR || level == SCAN_AUTO;
+#endif
+}
+
+static void resolveCandidateScan(void) {
+    ScanLevel level = requestedLevel;
+
+    if (level == SCAN_AUTO) {
+        level = cpuSupports(SCAN_AVX2) ? SCAN_AVX2
+              : cpuSupports(SCAN_SSE2) ? SCAN_SSE2 : SCAN_SCALAR;
+    } else if (!cpuSupports(level)) {
+        level = SCAN_SCALAR;
+    }
+
+    switch (level) {
+#if HAVE_X86_SIMD
+        case SCAN_AVX2: activeScan = scanAVX2; activeLetterScan = letterAVX2; break;
+        case SCAN_SSE2: activeScan = scanSSE2; activeLetterScan = letterSSE2; break;
+#endif
+        default:
+            level = SCAN_SCALAR;
+            activeScan = scanScalar;
+            activeLetterScan = letterScalar;
+            break;
+    }
+    activeLevel = level;
+
+    debugPrint("DEBUG Scan: using %s candidate scan\n", SCAN_LEVEL_NAMES[activeLevel]);
+}
+
+bool selectCandidateScan(const char* name) {
+    for (int i = 0; i < SCAN_LEVELS_COUNT; i++) {
+        if (strcmp(name, SCAN_LEVEL_NAMES[i]) == 0) {
+            requestedLevel = (ScanLevel)i;
+            activeScan = NULL;
+            return true;
+        }
+    }
+    return false;
+}
+
+void initCandidateScan(void) {
+    if (!activeScan) resolveCandidateScan();
+}
+
+const char* candidateScanName(void) {
+    if (!activeScan) resolveCandidateScan();
+    return SCAN_LEVEL_NAMES[activeLevel];
+}
+
+void findCandidateCells(const Grid* grid, int row, const char* folded, int len,
+                        uint64_t* mask) {
+    if (!activeScan) resolveCandidateScan();
+
+    memset(mask, 0, ((grid->cols + 63) / 64) * sizeof(uint64_t));
+    activeScan(Grid_cellPtr(grid, row, 0), grid->stride, grid->cols,
+               folded[0], len > 1 ? folded[1] : 0, len > 1, mask);
+}
+
+void findLetterCells(const Grid* grid, int row, int firstCol, int count,
+                     const char* letters, uint64_t* const* masks) {
+    if (!activeScan) resolveCandidateScan();
+
+    activeLetterScan(Grid_cellPtr(grid, row, firstCol), count, letters, masks);
+}
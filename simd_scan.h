@@ -0,0 +1,36 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+#include "types.h"
+#include "grid.h"
+#include <stdint.h>
+
+// Instruction sets the candidate scan can run on
+typedef enum {
+    SCAN_AUTO,          // Best level supported by the running CPU
+    SCAN_SCALAR,
+    SCAN_SSE2,
+    SCAN_AVX2,
+    SCAN_LEVELS_COUNT
+} ScanLevel;
+
+bool selectCandidateScan(const char* name);
+void initCandidateScan(void);
+const char* candidateScanName(void);
+
+// Sets bit j of mask (one uint64_t per 64 columns) for every column of the
+// row whose cell equals folded[0] and, when len > 1, has folded[1] in one of
+// its 8 neighbours. Needs the padded search layout with halo >= 1 for len > 1.
+void findCandidateCells(const Grid* grid, int row, const char* folded, int len,
+                        uint64_t* mask);
+
+// Letters compared in one pass over a row
+#define SCAN_LETTERS 4
+
+// Sets bit k of masks[i] (one uint64_t per 64 cells) for every cell
+// firstCol + k of the row, k < count, that equals letters[i]. Reads only
+// those cells, so the window may reach into the halo of the padded layout.
+void findLetterCells(const Grid* grid, int row, int firstCol, int count,
+                     const char* letters, uint64_t* const* masks);
+
+#endif // SIMD_SCAN_H
@@ -0,0 +1,137 @@
+#include "thread_pool.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Initial block of each thread's scratch arena; grows on demand
+#define SCRATCH_ARENA_BLOCK (64 * 1024)
+
+typedef struct {
+    ThreadPool* pool;
+    int thread;
+} HelperArgs;
+
+static void* helperMain(void* arg) {
+    HelperArgs args = *(HelperArgs*)arg;
+    ThreadPool* pool = args.pool;
+    free(arg);
+
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stopping && pool->generation == seen) {
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        }
+        if (pool->stopping) break;
+
+        seen = pool->generation;
+        ThreadTask task = pool->task;
+        void* context = pool->context;
+        pthread_mutex_unlock(&pool->lock);
+
+        task(args.thread, context);
+
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->pending == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+
+    return NULL;
+}
+
+ThreadPool* ThreadPool_create(int threadCount) {
+    if (threadCount < 1) threadCount = 1;
+
+    ThreadPool* pool = (ThreadPool*)calloc(1, sizeof(ThreadPool));
+    if (!pool) return NULL;
+
+    pool->threads = (pthread_t*)malloc((threadCount > 1 ? threadCount - 1 : 1) * sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+
+    pool->arenaCount = threadCount;
+    pool->arenas = (Arena**)calloc(threadCount, sizeof(Arena*));
+    for (int t = 0; pool->arenas && t < threadCount; t++) {
+        pool->arenas[t] = Arena_create(SCRATCH_ARENA_BLOCK);
+        if (!pool->arenas[t]) break;
+    }
+    if (!pool->arenas || !pool->arenas[threadCount - 1]) {
+        for (int t = 0; pool->arenas && t < threadCount; t++) {
+            Arena_destroy(pool->arenas[t]);
+        }
+        free(pool->arenas);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->threadCount = 1;
+
+    for (int t = 1; t < threadCount; t++) {
+        HelperArgs* args = (HelperArgs*)malloc(sizeof(HelperArgs));
+        if (!args) break;
+        args->pool = pool;
+        args->thread = t;
+
+        if (pthread_create(&pool->threads[t - 1], NULL, helperMain, args) != 0) {
+            fprintf(stderr, "Warning: Could only start %d of %d threads\n", t, threadCount);
+            free(args);
+            break;
+        }
+        pool->threadCount++;
+    }
+
+    debugPrint("DEBUG Pool: %d threads started\n", pool->threadCount);
+    return pool;
+}
+
+void ThreadPool_destroy(ThreadPool* pool) {
+    if (!pool) return;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (int t = 1; t < pool->threadCount; t++) {
+        pthread_join(pool->threads[t - 1], NULL);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+
+    // Arenas exist for every requested thread, started or not
+    for (int t = 0; t < pool->arenaCount; t++) {
+        Arena_destroy(pool->arenas[t]);
+    }
+    free(pool->arenas);
+    free(pool->threads);
+    free(pool);
+}
+
+void ThreadPool_run(ThreadPool* pool, ThreadTask task, void* context) {
+    pthread_mutex_lock(&pool->lock);
+    pool->task = task;
+    pool->context = context;
+    pool->pending = pool->threadCount - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    // The caller works as thread 0
+    task(0, context);
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,36 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include "arena.h"
+
+// Task run once on every thread of the pool; thread 0 is the calling thread
+typedef void (*ThreadTask)(int thread, void* context);
+
+// Persistent threads parked on a condition variable between runs, so one
+// pool serves every search of the process without respawning threads
+typedef struct {
+    pthread_t* threads;         // threadCount - 1 helper threads
+    int threadCount;
+    Arena** arenas;             // Scratch arena per thread, reset by its user
+    int arenaCount;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;        // Signalled when a new run starts
+    pthread_cond_t done;        // Signalled when the last helper finishes
+    ThreadTask task;
+    void* context;
+    unsigned long generation;   // Incremented per run
+    int pending;                // Helpers still running the current task
+    bool stopping;
+} ThreadPool;
+
+ThreadPool* ThreadPool_create(int threadCount);
+void ThreadPool_destroy(ThreadPool* pool);
+void ThreadPool_run(ThreadPool* pool, ThreadTask task, void* context);
+
+static inline Arena* ThreadPool_arena(ThreadPool* pool, int thread) {
+    return pool->arenas[thread];
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,225 @@
+#include "tiles.h"
+#include "search.h"
+#include "debug.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Largest padded tile for a dims[0] x dims[1] process grid
+static long paddedTileCells(int rows, int cols, int halo, int procRows, int procCols) {
+    return (long)((rows + procRows - 1) / procRows + 2 * halo) *
+           ((cols + procCols - 1) / procCols + 2 * halo);
+}
+
+// Picks the factorisation of size with the smallest padded tile, preferring
+// ones whose tiles are all at least halo wide so ghosts can come from neighbours
+static void chooseProcessGrid(int size, int rows, int cols, int halo, int dims[2]) {
+    long best = -1;
+    bool bestExchange = false;
+
+    for (int procRows = 1; procRows <= size; procRows++) {
+        if (size % procRows != 0) continue;
+        int procCols = size / procRows;
+
+        bool exchange = rows / procRows >= halo && cols / procCols >= halo;
+        long cells = paddedTileCells(rows, cols, halo, procRows, procCols);
+
+        if (best < 0 || (exchange && !bestExchange) ||
+            (exchange == bestExchange && cells < best)) {
+            best = cells;
+            bestExchange = exchange;
+            dims[0] = procRows;
+            dims[1] = procCols;
+        }
+    }
+}
+
+static void tileRanges(const TileLayout* layout, const int coords[2],
+                       RowRange* rows, RowRange* cols) {
+    *rows = splitRowRange((RowRange){0, layout->gridRows}, coords[0], layout->dims[0]);
+    *cols = splitRowRange((RowRange){0, layout->gridCols}, coords[1], layout->dims[1]);
+}
+
+bool TileLayout_create(MPI_Comm comm, int rows, int cols, int halo, TileLayout* layout) {
+    int size, rank;
+    MPI_Comm_size(comm, &size);
+
+    memset(layout, 0, sizeof(TileLayout));
+    layout->gridRows = rows;
+    layout->gridCols = cols;
+    layout->halo = halo > 0 ? halo : 0;
+    chooseProcessGrid(size, rows, cols, layout->halo, layout->dims);
+    layout->exchange = rows / layout->dims[0] >= layout->halo &&
+                       cols / layout->dims[1] >= layout->halo;
+
+    // Periodic in both dimensions: the grid is a torus. Ranks keep their
+    // numbers in comm so its rank 0 still owns the puzzle.
+    int periods[2] = {1, 1};
+    if (MPI_Cart_create(comm, 2, layout->dims, periods, 0,
+                        &layout->cart) != MPI_SUCCESS) {
+        return false;
+    }
+
+    MPI_Comm_rank(layout->cart, &rank);
+    MPI_Cart_coords(layout->cart, rank, 2, layout->coords);
+    tileRanges(layout, layout->coords, &layout->rows, &layout->cols);
+
+    debugPrint("DEBUG Tiles: process %d owns rows %d-%d, cols %d-%d of a %d x %d process grid\n",
+               rank, layout->rows.start, layout->rows.end - 1,
+               layout->cols.start, layout->cols.end - 1, layout->dims[0], layout->dims[1]);
+    return true;
+}
+
+void TileLayout_destroy(TileLayout* layout) {
+    if (layout->cart != MPI_COMM_NULL) {
+        MPI_Comm_free(&layout->cart);
+    }
+}
+
+// Folded copy of a tile and its wrapped ghost border, taken from the full grid
+static void packPaddedTile(const Grid* grid, RowRange rows, RowRange cols, int halo,
+                           char* out) {
+    for (int r = rows.start - halo; r < rows.end + halo; r++) {
+        const char* source = grid->letters[(r % grid->rows + grid->rows) % grid->rows];
+        for (int c = cols.start - halo; c < cols.end + halo; c++) {
+            *out++ = (char)tolower((unsigned char)source[(c % grid->cols + grid->cols) % grid->cols]);
+        }
+    }
+}
+
+// Fills the ghost border from the four neighbours: columns across the tile's
+// own rows first, then whole padded rows, which carries the corners along
+static void exchangeHalo(Grid* tile, MPI_Comm cart) {
+    int halo = tile->halo;
+    int stride = tile->stride;
+    if (halo == 0) return;
+
+    int up, down, left, right;
+    MPI_Cart_shift(cart, 0, 1, &up, &down);
+    MPI_Cart_shift(cart, 1, 1, &left, &right);
+
+    MPI_Datatype edge;
+    MPI_Type_vector(tile->rows, halo, stride, MPI_CHAR, &edge);
+    MPI_Type_commit(&edge);
+
+    char* band = tile->cells + (size_t)halo * stride;
+    MPI_Sendrecv(band + halo, 1, edge, left, TAG_HALO,
+                 band + halo + tile->cols, 1, edge, right, TAG_HALO,
+                 cart, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(band + tile->cols, 1, edge, right, TAG_HALO,
+                 band, 1, edge, left, TAG_HALO,
+                 cart, MPI_STATUS_IGNORE);
+    MPI_Type_free(&edge);
+
+    int count = halo * stride;
+    MPI_Sendrecv(tile->cells + (size_t)halo * stride, count, MPI_CHAR, up, TAG_HALO,
+                 tile->cells + (size_t)(halo + tile->rows) * stride, count, MPI_CHAR, down, TAG_HALO,
+                 cart, MPI_STATUS_IGNORE);
+    MPI_Sendrecv(tile->cells + (size_t)tile->rows * stride, count, MPI_CHAR, down, TAG_HALO,
+                 tile->cells, count, MPI_CHAR, up, TAG_HALO,
+                 cart, MPI_STATUS_IGNORE);
+}
+
+// Sends every other process its tile straight out of the full grid
+static void sendTiles(const Grid* grid, const TileLayout* layout, char* padded) {
+    int size;
+    MPI_Comm_size(layout->cart, &size);
+
+    for (int proc = 1; proc < size; proc++) {
+        int coords[2];
+        RowRange rows, cols;
+        MPI_Cart_coords(layout->cart, proc, 2, coords);
+        tileRanges(layout, coords, &rows, &cols);
+
+        int tileRows = rows.end - rows.start;
+        int tileCols = cols.end - cols.start;
+        if (tileRows > 0 && tileCols > 0) {
+            int sizes[2] = {grid->rows, grid->cols};
+            int subsizes[2] = {tileRows, tileCols};
+            int starts[2] = {rows.start, cols.start};
+            MPI_Datatype block;
+            MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_CHAR, &block);
+            MPI_Type_commit(&block);
+            MPI_Send(grid->letters[0], 1, block, proc, TAG_TILE, layout->cart);
+            MPI_Type_free(&block);
+        }
+
+        // Tiles thinner than the ghost border cannot be filled by their
+        // neighbours; rank 0 sends the whole padded tile instead
+        if (!layout->exchange) {
+            packPaddedTile(grid, rows, cols, layout->halo, padded);
+            MPI_Send(padded, (tileRows + 2 * layout->halo) * (tileCols + 2 * layout->halo),
+                     MPI_CHAR, proc, TAG_TILE_PADDED, layout->cart);
+        }
+    }
+}
+
+Grid* scatterTiles(const Grid* grid, const TileLayout* layout) {
+    int rank;
+    MPI_Comm_rank(layout->cart, &rank);
+
+    int tileRows = layout->rows.end - layout->rows.start;
+    int tileCols = layout->cols.end - layout->cols.start;
+    int halo = layout->halo;
+
+    Grid* tile = Grid_create(tileRows, tileCols);
+    if (!tile) return NULL;
+
+    // An empty grid has no cells to send and no wrap to fill ghosts from;
+    // every tile is empty and stays without a padded layout
+    if (layout->gridRows == 0 || layout->gridCols == 0) return tile;
+
+    tile->halo = halo;
+    tile->stride = tileCols + 2 * halo;
+    tile->cells = (char*)malloc((size_t)tile->stride * (tileRows + 2 * halo) + 1);
+    if (!tile->cells) {
+        Grid_destroy(tile);
+        return NULL;
+    }
+
+    if (rank == 0) {
+        char* padded = NULL;
+        if (!layout->exchange) {
+            padded = (char*)malloc(paddedTileCells(grid->rows, grid->cols, halo,
+                                                   layout->dims[0], layout->dims[1]));
+            if (!padded) {
+                Grid_destroy(tile);
+                return NULL;
+            }
+        }
+        sendTiles(grid, layout, padded);
+        free(padded);
+
+        for (int i = 0; i < tileRows; i++) {
+            memcpy(tile->letters[i], grid->letters[layout->rows.start + i] + layout->cols.start,
+                   tileCols);
+        }
+        if (!layout->exchange) {
+            packPaddedTile(grid, layout->rows, layout->cols, halo, tile->cells);
+        }
+    } else {
+        if (tileRows > 0 && tileCols > 0) {
+            MPI_Recv(tile->letters[0], tileRows * tileCols, MPI_CHAR, 0, TAG_TILE,
+                     layout->cart, MPI_STATUS_IGNORE);
+        }
+        if (!layout->exchange) {
+            MPI_Recv(tile->cells, tile->stride * (tileRows + 2 * halo), MPI_CHAR, 0,
+                     TAG_TILE_PADDED, layout->cart, MPI_STATUS_IGNORE);
+        }
+    }
+
+    if (layout->exchange) {
+        for (int i = 0; i < tileRows; i++) {
+            char* target = tile->cells + (size_t)(i + halo) * tile->stride + halo;
+            for (int j = 0; j < tileCols; j++) {
+                target[j] = (char)tolower((unsigned char)tile->letters[i][j]);
+            }
+        }
+        exchangeHalo(tile, layout->cart);
+    }
+
+    debugPrint("DEBUG Tiles: process %d holds a %d x %d padded tile\n",
+               rank, tileRows + 2 * halo, tile->stride);
+    return tile;
+}
@@ -0,0 +1,29 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include "types.h"
+#include "grid.h"
+#include <mpi.h>
+
+#define TAG_TILE 103
+#define TAG_TILE_PADDED 104
+#define TAG_HALO 105
+
+// 2D block decomposition of the grid over a periodic process grid
+typedef struct {
+    int gridRows;
+    int gridCols;
+    int dims[2];        // Processes along rows and columns
+    int coords[2];      // This process's position in the process grid
+    RowRange rows;      // Grid rows owned by this process
+    RowRange cols;      // Grid columns owned by this process
+    int halo;           // Ghost border width, longest word length - 1
+    bool exchange;      // Every tile is at least halo wide, so neighbours can fill the ghosts
+    MPI_Comm cart;
+} TileLayout;
+
+bool TileLayout_create(MPI_Comm comm, int rows, int cols, int halo, TileLayout* layout);
+void TileLayout_destroy(TileLayout* layout);
+Grid* scatterTiles(const Grid* grid, const TileLayout* layout);
+
+#endif // TILES_H
@@ -0,0 +1,178 @@
+#include "trie.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include "constants.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+static int Trie_addNode(Trie* trie) {
+    if (trie->nodeCount >= trie->nodeCapacity) {
+        int capacity = trie->nodeCapacity * 2;
+        int* children = realloc(trie->children,
+                                (size_t)capacity * trie->alphabetSize * sizeof(int));
+        if (!children) return -1;
+        trie->children = children;
+
+        int* firstWord = realloc(trie->firstWord, capacity * sizeof(int));
+        if (!firstWord) return -1;
+        trie->firstWord = firstWord;
+
+        trie->nodeCapacity = capacity;
+    }
+
+    int node = trie->nodeCount++;
+    memset(trie->children + (size_t)node * trie->alphabetSize, 0xff,
+           trie->alphabetSize * sizeof(int));
+    trie->firstWord[node] = -1;
+    return node;
+}
+
+Trie* Trie_create(const WordList* words) {
+    int numWords = words->count;
+    Trie* trie = (Trie*)calloc(1, sizeof(Trie));
+    if (!trie) return NULL;
+
+    // Build the symbol table from the letters actually used by the words
+    for (int w = 0; w < numWords; w++) {
+        for (const char* c = WordList_folded(words, w); *c; c++) {
+            unsigned char letter = (unsigned char)*c;
+            if (!trie->symbols[letter]) {
+                trie->symbols[letter] = (unsigned char)(++trie->alphabetSize);
+            }
+        }
+    }
+    trie->maxDepth = words->longest;
+    if (trie->alphabetSize == 0) trie->alphabetSize = 1;
+
+    trie->nodeCapacity = INITIAL_GRID_CAPACITY;
+    trie->children = (int*)malloc((size_t)trie->nodeCapacity * trie->alphabetSize * sizeof(int));
+    trie->firstWord = (int*)malloc(trie->nodeCapacity * sizeof(int));
+    trie->nextWord = (int*)malloc((numWords > 0 ? numWords : 1) * sizeof(int));
+
+    if (!trie->children || !trie->firstWord || !trie->nextWord || Trie_addNode(trie) < 0) {
+        Trie_destroy(trie);
+        return NULL;
+    }
+
+    // Insert the words in reverse so each node lists its words in input order
+    for (int w = numWords - 1; w >= 0; w--) {
+        trie->nextWord[w] = -1;
+        if (WordList_length(words, w) == 0) continue;
+
+        int node = 0;
+        for (const char* c = WordList_folded(words, w); *c; c++) {
+            int symbol = trie->symbols[(unsigned char)*c] - 1;
+            int* edge = &trie->children[(size_t)node * trie->alphabetSize + symbol];
+
+            if (*edge < 0) {
+                int child = Trie_addNode(trie);
+                if (child < 0) {
+                    Trie_destroy(trie);
+                    return NULL;
+                }
+                // Re-read the edge, the child table may have moved
+                edge = &trie->children[(size_t)node * trie->alphabetSize + symbol];
+                *edge = child;
+            }
+            node = *edge;
+        }
+
+        trie->nextWord[w] = trie->firstWord[node];
+        trie->firstWord[node] = w;
+    }
+
+    debugPrint("DEBUG Trie: %d words, %d nodes, %d symbols, depth %d\n",
+               numWords, trie->nodeCount, trie->alphabetSize, trie->maxDepth);
+
+    return trie;
+}
+
+void Trie_destroy(Trie* trie) {
+    if (!trie) return;
+
+    free(trie->children);
+    free(trie->firstWord);
+    free(trie->nextWord);
+    free(trie);
+}
+
+// Matches every word starting in range against a trie built beforehand,
+// so the row blocks of one search can share it. Needs the padded layout
+// with a halo of at least trie->maxDepth - 1.
+void searchTrieRows(Grid* grid, const Trie* trie, const WordList* words, RowRange range,
+                    ProcessResults* results) {
+    int hitCapacity = INITIAL_GRID_CAPACITY;
+    int numHits = 0;
+    SearchHit* hits = (SearchHit*)malloc(hitCapacity * sizeof(SearchHit));
+    bool ok = hits != NULL;
+
+    int steps[DIRECTIONS_COUNT];
+    for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+        steps[dir] = Grid_stepOffset(grid, DIRECTION_VECTORS[dir].dx, DIRECTION_VECTORS[dir].dy);
+    }
+
+    for (int i = range.start; i < range.end && ok; i++) {
+        const char* rowCells = Grid_cellPtr(grid, i, 0);
+
+        for (int j = 0; j < grid->cols && ok; j++) {
+            // Every direction shares the first edge
+            int first = trie->symbols[(unsigned char)rowCells[j]];
+            if (!first || trie->children[first - 1] < 0) continue;
+
+            for (Direction dir = 0; dir < DIRECTIONS_COUNT; dir++) {
+                const char* cell = rowCells + j;
+                int node = 0;
+
+                // Walk the direction once, following every word sharing the prefix
+                for (int depth = 0; depth < trie->maxDepth; depth++, cell += steps[dir]) {
+                    int symbol = trie->symbols[(unsigned char)*cell];
+                    if (!symbol) break;
+
+                    node = trie->children[(size_t)node * trie->alphabetSize + symbol - 1];
+                    if (node < 0) break;
+
+                    for (int w = trie->firstWord[node]; w >= 0 && ok; w = trie->nextWord[w]) {
+                        ok = pushSearchHit(&hits, &numHits, &hitCapacity, (SearchHit){w, i, j, dir});
+                    }
+                }
+            }
+        }
+    }
+
+    if (!ok) {
+        fprintf(stderr, "Error: Failed to allocate memory for trie matches\n");
+        free(hits);
+        searchWords(grid, words, range, results);
+        return;
+    }
+
+    appendSortedHits(grid, words, hits, numHits, results);
+    if (words->count > results->totalProcessed) {
+        results->totalProcessed = words->count;
+    }
+    debugPrint("Trie search found %d matches in rows %d to %d\n",
+               numHits, range.start, range.end - 1);
+
+    free(hits);
+}
+
+// Uses the automaton that comes with the words, from a compiled dictionary,
+// or builds one for this search
+void searchWordsTrie(Grid* grid, const WordList* words, RowRange range,
+                     ProcessResults* results) {
+    bool prebuilt = words->trie != NULL;
+    Trie* trie = prebuilt ? (Trie*)words->trie : Trie_create(words);
+    if (searchWordsFallback(grid, words, range, results, trie != NULL)) return;
+
+    // Walks never leave the halo, so the longest word bounds the halo width
+    if (Grid_ensureSearchLayout(grid, trie->maxDepth - 1)) {
+        searchTrieRows(grid, trie, words, range, results);
+    } else {
+        searchWords(grid, words, range, results);
+    }
+
+    if (!prebuilt) Trie_destroy(trie);
+}
@@ -0,0 +1,27 @@
+#ifndef TRIE_H
+#define TRIE_H
+
+#include "types.h"
+#include "grid.h"
+
+// Shared-prefix automaton over the whole word list. Symbols are the distinct
+// (lowercased) bytes that appear in the words, so the child table stays small.
+typedef struct Trie {
+    int* children;          // nodeCount x alphabetSize, -1 when there is no edge
+    int* firstWord;         // First word index ending at each node, -1 if none
+    int* nextWord;          // Next word index ending at the same node, -1 if none
+    int nodeCount;
+    int nodeCapacity;
+    int alphabetSize;
+    int maxDepth;           // Length of the longest word
+    unsigned char symbols[256];     // Byte -> symbol + 1, 0 when unused
+} Trie;
+
+Trie* Trie_create(const WordList* words);
+void Trie_destroy(Trie* trie);
+void searchTrieRows(Grid* grid, const Trie* trie, const WordList* words, RowRange range,
+                    ProcessResults* results);
+void searchWordsTrie(Grid* grid, const WordList* words, RowRange range,
+                     ProcessResults* results);
+
+#endif // TRIE_H
@@ -2,14 +2,12 @@
 #define TYPES_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include "arena.h"
 
-#define MAX_WORD_LENGTH 50
-#define MAX_WORDS 100
-#define MAX_LINE_LENGTH 2000
 #define INITIAL_GRID_CAPACITY 10
 #define DIRECTIONS_COUNT 8
-#define MAX_RESULTS_PER_WORD (DIRECTIONS_COUNT)
-#define MAX_TOTAL_RESULTS (MAX_WORDS * MAX_RESULTS_PER_WORD)
+#define FORWARD_DIRECTIONS_COUNT 4
 #define DEBUG 0
 
 // Enumeration for search directions
@@ -24,6 +22,19 @@ typedef enum {
     DIR_DOWN_RIGHT
 } Direction;
 
+// Enumeration for search engines
+typedef enum {
+    ENGINE_BRUTE,       // One grid pass per word (searchWordParallel)
+    ENGINE_TRIE,        // One grid pass for the whole word list
+    ENGINE_LINES,       // Substring search over extracted direction lines
+    ENGINE_BITPLANE,    // Shifted ANDs over per-letter bit planes
+    ENGINE_INDEX,       // Verifies the start positions of a grid k-gram index
+    ENGINE_ROLLING,     // Rabin-Karp hashes along direction lines, one pass per word length
+    ENGINE_ANCHOR,      // Tries only the cells holding each word's rarest letter
+    ENGINE_FOLDED,      // Brute search over 4 directions with each word and its reverse
+    SEARCH_ENGINES_COUNT
+} SearchEngine;
+
 // Basic structures
 typedef struct {
     int dx;
@@ -43,20 +54,55 @@ typedef struct {
     int startCol;
     int endRow;
     int endCol;
-    char word[MAX_WORD_LENGTH];
+    int wordIndex;      // Index into the word list
+    Direction dir;
+    const char* word;   // Points into the word list's text pool
 } WordPosition;
 
+// Match found by a multi-word engine, resolved into a WordPosition later
 typedef struct {
+    int word;           // Index into the word list
+    int row;
+    int col;
+    Direction dir;
+} SearchHit;
+
+// Growable result buffer; positions live in the arena and are released
+// with it
+typedef struct {
+    WordPosition* positions;
     int validResults;
     int totalProcessed;
-    WordPosition positions[MAX_TOTAL_RESULTS];
+    int capacity;
+    bool failed;        // A result did not fit and was dropped
+    long candidates;    // Start positions tried by the anchor engine
+    long firstLetterCandidates;     // Those anchoring on the first letter would try
+    int rejectedWords;  // Words the prefilter ruled out before the search
+    Arena* arena;
 } ProcessResults;
 
+// Every word back to back in one pool, each NUL-terminated. Word i starts
+// at offsets[i] in both text and its lowercase copy folded.
+typedef struct {
+    char* text;
+    char* folded;
+    size_t* offsets;
+    int* lengths;
+    int count;
+    int longest;
+    const struct Trie* trie;    // Prebuilt automaton over exactly these words, or NULL
+} WordList;
+
 typedef struct {
-    char** letters;
-    char** highlighted;
+    char** letters;         // Row pointers into one contiguous row-major block
+    char** highlighted;     // Same layout as letters
+    char* cells;            // Case-folded search copy padded with a wrapped halo
+    int stride;             // Row length of cells (cols + 2 * halo)
+    int halo;               // Halo width on every side of cells
     int rows;
     int cols;
+    bool sharedLetters;     // letters point into memory the grid does not own
+    const struct GridIndex* index;  // k-gram index of these cells, or NULL; not owned
 } Grid;
 
 typedef struct {
@@ -67,6 +113,66 @@ typedef struct {
 typedef struct {
     char* outputFile;   // Output file path
     bool useHTML;       // HTML output flag
+    const char* inputFile;  // Puzzle file path; NULL reads stdin
+    bool parallelRead;      // Every process reads its rows of a .wsb input with MPI-IO
+    bool batch;             // Solve every puzzle of the input in one run
+    const char* manifestFile;   // Batch puzzle list, one path per line
+    int groupSize;          // Processes per batch group; 0 sizes them per window
+    const char* serveSocket;    // Answer queries on this Unix socket instead of solving once
+    const char* dictionaryFile; // Search for the words of this compiled dictionary
+    const char* indexFile;      // Saved grid index, reused while it matches the grid
 } OutputOptions;
 
+// How a process spreads its search over its threads
+typedef enum {
+    SCHEDULE_STATIC,    // One slice of rows (or words) per thread
+    SCHEDULE_STEAL,     // (word, row block) tasks on work-stealing deques
+    SCHEDULES_COUNT
+} ScheduleMode;
+
+// How rows are assigned to processes
+typedef enum {
+    DISTRIBUTION_STATIC,    // One contiguous slab per process, fixed up front
+    DISTRIBUTION_DYNAMIC,   // Guided chunks handed out by rank 0 on request
+    DISTRIBUTION_TILES,     // 2D tiles with ghost borders, no full-grid copies
+    DISTRIBUTION_WORDS,     // Word list split, every process searches all rows
+    DISTRIBUTION_HYBRID,    // Rows x words process grid
+    DISTRIBUTION_AUTO,      // Cost model picks rows, words or hybrid
+    DISTRIBUTIONS_COUNT
+} DistributionMode;
+
+typedef struct {
+    SearchEngine engine;    // Search engine used by every process
+    int threads;            // Search threads per process
+    ScheduleMode schedule;  // Thread scheduling inside each process
+    DistributionMode distribution;  // Row assignment across processes
+    bool prefilter;         // Rule out words whose letters or grams are not in the grid
+} SearchOptions;
+
+typedef struct {
+    int chunks;         // Row chunks searched by a process
+    int rows;           // Rows in those chunks
+} ChunkStats;
+
+typedef struct {
+    RowRange rows;      // Grid rows owned by a process's tile
+    RowRange cols;      // Grid columns owned by the tile
+    int halo;           // Ghost border width around the tile
+    long cells;         // Grid cells held, ghost border included
+} TileStats;
+
+typedef struct {
+    int rowParts;       // Row slabs
+    int wordParts;      // Word list slices; rowParts * wordParts == processes
+    double predicted;   // Search seconds predicted by the cost model
+    double actual;      // Search seconds measured on the slowest process
+} WorkPlan;
+
+typedef struct {
+    double busy;        // Seconds spent running tasks
+    double idle;        // Seconds of the parallel phase spent not running tasks
+    int tasks;          // Tasks run, own and stolen
+    int steals;         // Tasks taken from another thread's deque
+} WorkerStats;
+
 #endif // TYPES_H
@@ -0,0 +1,93 @@
+#include "word_list.h"
+#include <string.h>
+#include <ctype.h>
+
+// Reserves room for count words holding letters letters in total; the
+// words are then filled in order with WordList_set
+bool WordList_init(WordList* words, Arena* arena, int count, size_t letters) {
+    size_t poolBytes = letters + count;
+
+    memset(words, 0, sizeof(WordList));
+    words->text = (char*)Arena_alloc(arena, poolBytes);
+    words->folded = (char*)Arena_alloc(arena, poolBytes);
+    words->offsets = (size_t*)Arena_alloc(arena, (count > 0 ? count : 1) * sizeof(size_t));
+    words->lengths = (int*)Arena_alloc(arena, (count > 0 ? count : 1) * sizeof(int));
+    words->count = count;
+
+    return words->text && words->folded && words->offsets && words->lengths;
+}
+
+void WordList_set(WordList* words, int index, const char* word, int len) {
+    size_t offset = index == 0 ? 0 : words->offsets[index - 1] + words->lengths[index - 1] + 1;
+    char* text = words->text + offset;
+    char* folded = words->folded + offset;
+
+    for (int i = 0; i < len; i++) {
+        text[i] = word[i];
+        folded[i] = (char)tolower((unsigned char)word[i]);
+    }
+    text[len] = '\0';
+    folded[len] = '\0';
+
+    words->offsets[index] = offset;
+    words->lengths[index] = len;
+    if (len > words->longest) words->longest = len;
+}
+
+// View of count words starting at first; shares the pools of words
+WordList WordList_slice(const WordList* words, int first, int count) {
+    WordList slice = *words;
+    slice.offsets = words->offsets + first;
+    slice.lengths = words->lengths + first;
+    slice.count = count;
+    slice.longest = 0;
+    slice.trie = NULL;
+
+    for (int i = 0; i < count; i++) {
+        if (slice.lengths[i] > slice.longest) slice.longest = slice.lengths[i];
+    }
+    return slice;
+}
+
+size_t WordList_tableBytes(const WordList* words) {
+    size_t bytes = 0;
+    for (int i = 0; i < words->count; i++) {
+        bytes += sizeof(int) + words->lengths[i];
+    }
+    return bytes;
+}
+
+void WordList_pack(const WordList* words, char* table) {
+    for (int i = 0; i < words->count; i++) {
+        int len = words->lengths[i];
+        memcpy(table, &len, sizeof(int));
+        memcpy(table + sizeof(int), WordList_word(words, i), len);
+        table += sizeof(int) + len;
+    }
+}
+
+// Rebuilds count words from a table of tableBytes bytes, which may come
+// from a file: every length is checked against the table first
+bool WordList_unpack(WordList* words, Arena* arena, int count,
+                     const char* table, size_t tableBytes) {
+    if (count < 0) return false;
+
+    size_t used = 0;
+    for (int i = 0; i < count; i++) {
+        int len;
+        if (tableBytes - used < sizeof(int)) return false;
+        memcpy(&len, table + used, sizeof(int));
+        if (len < 0 || (size_t)len > tableBytes - used - sizeof(int)) return false;
+        used += sizeof(int) + len;
+    }
+
+    if (!WordList_init(words, arena, count, used - count * sizeof(int))) return false;
+
+    for (int i = 0; i < count; i++) {
+        int len;
+        memcpy(&len, table, sizeof(int));
+        WordList_set(words, i, table + sizeof(int), len);
+        table += sizeof(int) + len;
+    }
+    return true;
+}
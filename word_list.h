@@ -0,0 +1,29 @@
+#ifndef WORD_LIST_H
+#define WORD_LIST_H
+
+#include "types.h"
+
+bool WordList_init(WordList* words, Arena* arena, int count, size_t letters);
+void WordList_set(WordList* words, int index, const char* word, int len);
+WordList WordList_slice(const WordList* words, int first, int count);
+
+// Word table: per word, an int length followed by its letters without NUL.
+// Carries the words in the grid broadcast and in binary puzzle files.
+size_t WordList_tableBytes(const WordList* words);
+void WordList_pack(const WordList* words, char* table);
+bool WordList_unpack(WordList* words, Arena* arena, int count,
+                     const char* table, size_t tableBytes);
+
+static inline const char* WordList_word(const WordList* words, int index) {
+    return words->text + words->offsets[index];
+}
+
+static inline const char* WordList_folded(const WordList* words, int index) {
+    return words->folded + words->offsets[index];
+}
+
+static inline int WordList_length(const WordList* words, int index) {
+    return words->lengths[index];
+}
+
+#endif // WORD_LIST_H
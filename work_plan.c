@@ -0,0 +1,134 @@
+#include "work_plan.h"
+#include "search.h"
+#include "word_list.h"
+#include "debug.h"
+#include <stdio.h>
+#include <mpi.h>
+
+// Cost model weights, in cell visits. A word scanned over a row pays a
+// fixed setup, and every word pays once per process for folding and
+// candidate buffers.
+#define ROW_OVERHEAD 16.0
+#define WORD_OVERHEAD 256.0
+#define ALPHABET_SIZE 26.0
+
+// The probe grows until it takes at least this long, or covers the grid
+#define PROBE_SECONDS 0.002
+#define PROBE_WORDS 8
+#define PROBE_CELLS 4096
+
+bool isPlannedDistribution(DistributionMode distribution) {
+    return distribution == DISTRIBUTION_WORDS || distribution == DISTRIBUTION_HYBRID ||
+           distribution == DISTRIBUTION_AUTO;
+}
+
+const char* workPlanName(const WorkPlan* plan) {
+    if (plan->wordParts == 1) return "rows";
+    if (plan->rowParts == 1) return "words";
+    return "hybrid";
+}
+
+// Work of the busiest process, in cell visits: every cell of its rows is
+// scanned for each of its words, and a first-letter hit walks up to eight
+// directions. An empty grid or word list costs nothing.
+double workPlanUnits(int rows, int cols, int numWords, long totalLength,
+                     int rowParts, int wordParts) {
+    if (rows == 0 || cols == 0 || numWords == 0) return 0.0;
+
+    double rowShare = (rows + rowParts - 1) / rowParts;
+    double wordShare = (numWords + wordParts - 1) / wordParts;
+    double letters = (double)totalLength * wordShare / numWords;
+
+    return rowShare * cols * (wordShare + letters * DIRECTIONS_COUNT / ALPHABET_SIZE) +
+           wordShare * rowShare * ROW_OVERHEAD + wordShare * WORD_OVERHEAD;
+}
+
+static long totalWordLength(const WordList* words, int numWords) {
+    long total = 0;
+    for (int i = 0; i < numWords; i++) {
+        total += WordList_length(words, i);
+    }
+    return total;
+}
+
+// Seconds per unit of workPlanUnits, measured by searching the first words
+// over the first rows with the selected engine
+static double calibrateUnitSeconds(Grid* grid, const WordList* words, SearchEngine engine) {
+    if (grid->rows == 0 || grid->cols == 0) return 0.0;
+
+    int probeWords = words->count < PROBE_WORDS ? words->count : PROBE_WORDS;
+    int probeRows = 1 + PROBE_CELLS / grid->cols;
+    if (probeWords == 0) return 0.0;
+    if (probeRows > grid->rows) probeRows = grid->rows;
+
+    WordList probe = WordList_slice(words, 0, probeWords);
+    Arena* scratch = Arena_create(0);
+    if (!scratch) return 0.0;
+
+    double elapsed;
+    for (;;) {
+        Arena_reset(scratch);
+        ProcessResults results = ProcessResults_create(scratch);
+
+        double start = MPI_Wtime();
+        searchWordsWithEngine(grid, &probe, (RowRange){0, probeRows}, engine, &results);
+        elapsed = MPI_Wtime() - start;
+
+        if (elapsed >= PROBE_SECONDS || probeRows == grid->rows) break;
+        probeRows = probeRows * 2 < grid->rows ? probeRows * 2 : grid->rows;
+    }
+    Arena_destroy(scratch);
+
+    double units = workPlanUnits(probeRows, grid->cols, probeWords,
+                                 totalWordLength(words, probeWords), 1, 1);
+    debugPrint("DEBUG Plan: probe of %d rows x %d words took %.6f s\n",
+               probeRows, probeWords, elapsed);
+    return units > 0.0 ? elapsed / units : 0.0;
+}
+
+// Fills plans with every rows x words factorisation of size and its
+// predicted search time; plans needs room for size entries
+int listWorkPlans(Grid* grid, const WordList* words, int size,
+                  const SearchOptions* searchOptions, WorkPlan* plans) {
+    int numWords = words->count;
+
+    // The probe should not pay for the padded layout the search reuses
+    Grid_ensureSearchLayout(grid, words->longest - 1);
+
+    double unitSeconds = calibrateUnitSeconds(grid, words, searchOptions->engine);
+    long totalLength = totalWordLength(words, numWords);
+    int numPlans = 0;
+
+    for (int rowParts = size; rowParts >= 1; rowParts--) {
+        if (size % rowParts != 0) continue;
+
+        WorkPlan* plan = &plans[numPlans++];
+        plan->rowParts = rowParts;
+        plan->wordParts = size / rowParts;
+        plan->predicted = unitSeconds / searchOptions->threads *
+                          workPlanUnits(grid->rows, grid->cols, numWords, totalLength,
+                                        plan->rowParts, plan->wordParts);
+        plan->actual = 0.0;
+    }
+    return numPlans;
+}
+
+WorkPlan chooseWorkPlan(const WorkPlan* plans, int numPlans, DistributionMode distribution) {
+    const WorkPlan* best = NULL;
+    const WorkPlan* bestHybrid = NULL;
+
+    for (int i = 0; i < numPlans; i++) {
+        const WorkPlan* plan = &plans[i];
+        if (distribution == DISTRIBUTION_WORDS && plan->rowParts == 1) return *plan;
+
+        if (!best || plan->predicted < best->predicted) best = plan;
+        if (plan->rowParts > 1 && plan->wordParts > 1 &&
+            (!bestHybrid || plan->predicted < bestHybrid->predicted)) {
+            bestHybrid = plan;
+        }
+    }
+
+    // A prime process count has no hybrid split; take the cheapest plan instead
+    if (distribution == DISTRIBUTION_HYBRID && bestHybrid) return *bestHybrid;
+    return *best;
+}
@@ -0,0 +1,15 @@
+#ifndef WORK_PLAN_H
+#define WORK_PLAN_H
+
+#include "types.h"
+#include "grid.h"
+
+bool isPlannedDistribution(DistributionMode distribution);
+const char* workPlanName(const WorkPlan* plan);
+double workPlanUnits(int rows, int cols, int numWords, long totalLength,
+                     int rowParts, int wordParts);
+int listWorkPlans(Grid* grid, const WordList* words, int size,
+                  const SearchOptions* searchOptions, WorkPlan* plans);
+WorkPlan chooseWorkPlan(const WorkPlan* plans, int numPlans, DistributionMode distribution);
+
+#endif // WORK_PLAN_H